@@ -17,6 +17,16 @@
 #define M5_UNIT_UNIFIED_DDS_HPP
 
 #include "unit/unit_DDS.hpp"
+#include "unit/dds_scheduler.hpp"
+#include "unit/dds_chirp.hpp"
+#include "unit/dds_tone.hpp"
+#include "unit/dds_pair.hpp"
+#include "unit/dds_fm.hpp"
+#include "unit/dds_keyer.hpp"
+#include "unit/dds_dither.hpp"
+#include "unit/dds_group.hpp"
+#include "unit/dds_queue.hpp"
+#include "unit/dds_clock.hpp"
 /*!
   @namespace m5
   @brief Top level namespace of M5stack
@@ -1,38 +1,39 @@
 #include "Unit_DDS.h"
-#include <cstdio>
+
+namespace {
+// Calculate 28-bit FTW and 11-bit phase
+inline uint32_t to_ftw(uint64_t freq)
+{
+    return (freq * 268435456 / DDS_FMCLK) & 0x0FFFFFFF;
+}
+inline uint16_t to_phase(uint32_t phase)
+{
+    return (phase * 2048 / 360) & 0x07FF;
+}
+}  // namespace
 
 /*! @brief Write data to the DDS.*/
 void Unit_DDS::writeDDSReg(uint8_t addr, uint8_t data)
 {
     // Serial.printf("ADDR:%02X,DATA:%02X\r\n",addr,data);
-    _pwire->beginTransmission(DDS_UNIT_I2CADDR);
-    _pwire->write(addr);
-    _pwire->write(data);
-    _pwire->endTransmission();
+    writeDDSReg(addr, &data, 1);
 }
 
 /*! @brief Write a certain length of data to the DDS.*/
-void Unit_DDS::writeDDSReg(uint8_t addr, uint8_t* data, size_t size)
+void Unit_DDS::writeDDSReg(uint8_t addr, const uint8_t* data, size_t size)
 {
+    trace(addr, data, size);
     _pwire->beginTransmission(DDS_UNIT_I2CADDR);
     _pwire->write(addr);
-    for (size_t i = 0; i < size; i++) {
-        _pwire->write(data[i]);
-    }
+    _pwire->write(data, size);
     _pwire->endTransmission();
 }
 
 /*! @brief Read data from the DDS.*/
 uint8_t Unit_DDS::readDDSReg(uint8_t addr)
 {
-    uint8_t data;
-    _pwire->beginTransmission(DDS_UNIT_I2CADDR);
-    _pwire->write(addr);
-    _pwire->endTransmission();
-    _pwire->requestFrom(DDS_UNIT_I2CADDR, 1);
-    data = _pwire->read();
-    _pwire->endTransmission();
-
+    uint8_t data = 0;
+    readDDSRegs(addr, &data, 1);
     return data;
 }
 
@@ -41,12 +42,18 @@ void Unit_DDS::readDDSRegs(uint8_t addr, uint8_t* dataptr, uint8_t size)
 {
     _pwire->beginTransmission(DDS_UNIT_I2CADDR);
     _pwire->write(addr);
-    _pwire->endTransmission();
-    _pwire->requestFrom(DDS_UNIT_I2CADDR, (int)size);
-    for (int i = 0; i < 6; i++) {
-        dataptr[i] = _pwire->read();
+    _pwire->endTransmission(false);  // Repeated start
+    _pwire->requestFrom((uint8_t)DDS_UNIT_I2CADDR, size);
+    for (uint8_t i = 0; i < size; i++) {
+        dataptr[i] = _pwire->available() ? _pwire->read() : 0;
     }
-    _pwire->endTransmission();
+}
+
+/*! @brief Write CONTROL and update the shadow.*/
+void Unit_DDS::writeCTRL(uint8_t ctrlbyte)
+{
+    _ctrl = ctrlbyte & 0x7F;
+    writeDDSReg(DDS_CTRL_ADDR, 0x80 | _ctrl);
 }
 
 /*! @brief Initialize the DDS.
@@ -63,29 +70,34 @@ int Unit_DDS::begin(TwoWire* p)
 
     Serial.printf("sn:%s\r\n", snStr);
 
-    return (desc == String("ad9833")) ? 0 : -1;
+    if (desc != String("ad9833")) {
+        return -1;
+    }
+    // The only reads after begin, later changes are tracked in the shadow
+    _mode = readDDSReg(DDS_MODE_ADDE) & 0x7F;
+    _ctrl = readDDSReg(DDS_CTRL_ADDR) & 0x7F;
+    return 0;
 }
 
 /*! @brief Set the signal frequency.*/
 void Unit_DDS::setFreq(uint8_t reg, uint64_t freq)
 {
-    freq = freq * 268435456 / DDS_FMCLK;
-
+    uint32_t ftw        = to_ftw(freq);
     uint8_t sendbuff[4] = {0, 0, 0, 0};
-    sendbuff[0] |= (((freq >> 24) & 0xff) | (reg == 1) ? 0xC0 : 0x80);
-    sendbuff[1] |= ((freq >> 16) & 0xff);
-    sendbuff[2] |= ((freq >> 8) & 0xff);
-    sendbuff[3] |= (freq & 0xff);
+    sendbuff[0]         = ((ftw >> 24) & 0x0F) | ((reg == 1) ? 0xC0 : 0x80);
+    sendbuff[1]         = (ftw >> 16) & 0xff;
+    sendbuff[2]         = (ftw >> 8) & 0xff;
+    sendbuff[3]         = ftw & 0xff;
     writeDDSReg(DDS_FREQ_ADDR, sendbuff, 4);
 }
 
 /*! @brief Set the signal phase.*/
 void Unit_DDS::setPhase(uint8_t reg, uint32_t phase)
 {
+    uint16_t ph         = to_phase(phase);
     uint8_t sendbuff[2] = {0, 0};
-    phase               = phase * 2048 / 360;
-    sendbuff[0] |= (((phase >> 8) & 0xff) | ((reg == 1) ? 0xC0 : 0x80));
-    sendbuff[1] |= (phase & 0xff);
+    sendbuff[0]         = ((ph >> 8) & 0x07) | ((reg == 1) ? 0xC0 : 0x80);
+    sendbuff[1]         = ph & 0xff;
 
     // Serial.printf("%02X %02X",sendbuff[0],sendbuff[1]);
     writeDDSReg(DDS_PHASE_ADDR, sendbuff, 2);
@@ -94,20 +106,16 @@ void Unit_DDS::setPhase(uint8_t reg, uint32_t phase)
 /*! @brief Set the signal frequency and phase.*/
 void Unit_DDS::setFreqAndPhase(uint8_t freg, uint64_t freq, uint8_t preg, uint32_t phase)
 {
+    uint32_t ftw        = to_ftw(freq);
+    uint16_t ph         = to_phase(phase);
     uint8_t sendbuff[6] = {0, 0, 0, 0, 0, 0};
 
-    freq = freq * 268435456 / DDS_FMCLK;
-    sendbuff[0] |= (((freq >> 24) & 0xff) | (freg == 1) ? 0xC0 : 0x80);
-    sendbuff[1] |= ((freq >> 16) & 0xff);
-    sendbuff[2] |= ((freq >> 8) & 0xff);
-    sendbuff[3] |= (freq & 0xff);
-
-    phase = phase * 2048 / 360;
-    sendbuff[4] |= (((phase >> 8) & 0xff) | ((preg == 1) ? 0xC0 : 0x80));
-    sendbuff[5] |= (phase & 0xff);
-
-    std::printf("%02X:%02X:%02X:%02X:%02X:%02X\n", sendbuff[0], sendbuff[1], sendbuff[2], sendbuff[3], sendbuff[4],
-                sendbuff[5]);
+    sendbuff[0] = ((ftw >> 24) & 0x0F) | ((freg == 1) ? 0xC0 : 0x80);
+    sendbuff[1] = (ftw >> 16) & 0xff;
+    sendbuff[2] = (ftw >> 8) & 0xff;
+    sendbuff[3] = ftw & 0xff;
+    sendbuff[4] = ((ph >> 8) & 0x07) | ((preg == 1) ? 0xC0 : 0x80);
+    sendbuff[5] = ph & 0xff;
 
     writeDDSReg(DDS_FREQ_ADDR, sendbuff, 6);
 }
@@ -115,64 +123,94 @@ void Unit_DDS::setFreqAndPhase(uint8_t freg, uint64_t freq, uint8_t preg, uint32
 /*! @brief Set the type of output signal.*/
 void Unit_DDS::setMode(DDSmode mode)
 {
-    writeDDSReg(DDS_MODE_ADDE, 0x80 | mode);
+    _mode = mode & 0x7F;
+    writeDDSReg(DDS_MODE_ADDE, 0x80 | _mode);
 }
 
 /*! @brief Set the signal frequency and phase.*/
 void Unit_DDS::setCTRL(uint8_t ctrlbyte)
 {
-    writeDDSReg(DDS_CTRL_ADDR, 0x80 | ctrlbyte);
+    writeCTRL(ctrlbyte);
 }
 
 /*! @brief Select frequency register.*/
 void Unit_DDS::selectFreqReg(uint8_t num)
 {
-    uint8_t reg = readDDSReg(DDS_CTRL_ADDR);
-    reg &= (~0x40);
-    writeDDSReg(DDS_CTRL_ADDR, reg | 0x80 | (num == 1) ? 0x40 : 0);
+    writeCTRL((_ctrl & ~0x40) | ((num == 1) ? 0x40 : 0));
 }
 
 /*! @brief Select phase register.*/
 void Unit_DDS::selectPhaseReg(uint8_t num)
 {
-    uint8_t reg = readDDSReg(DDS_CTRL_ADDR);
-    reg &= (~0x20);
-    writeDDSReg(DDS_CTRL_ADDR, reg | 0x80 | (num == 1) ? 0x20 : 0);
+    writeCTRL((_ctrl & ~0x20) | ((num == 1) ? 0x20 : 0));
 }
 
 /*! @brief Output waveform with specified frequency and phase.*/
 void Unit_DDS::quickOUT(DDSmode mode, uint64_t freq, uint32_t phase)
 {
     if (mode <= kSQUAREMode) {
-        std::printf("====> setFreq\n");
         setFreqAndPhase(0, freq, 0, phase);
     }
-    writeDDSReg(0x20, 0x80 | mode);
-    writeDDSReg(0x21, 0x80);
-
-    std::printf("M:%02X C:%02X\n", 0x80 | mode, 0x80);
+    // MODE and CONTROL in a single burst
+    _mode               = mode & 0x7F;
+    _ctrl               = 0;
+    uint8_t sendbuff[2] = {(uint8_t)(0x80 | _mode), (uint8_t)(0x80 | _ctrl)};
+    writeDDSReg(DDS_MODE_ADDE, sendbuff, 2);
 }
 
 /*! @brief Output specified frequency and phase.*/
 void Unit_DDS::OUT(uint8_t freqnum, uint8_t phasenum)
 {
-    uint8_t reg = readDDSReg(DDS_CTRL_ADDR);
-    reg &= (~0x60);
-    writeDDSReg(DDS_CTRL_ADDR, reg | 0x80 | ((freqnum == 1) ? 0x40 : 0) | ((phasenum == 1) ? 0x20 : 0));
+    writeCTRL((_ctrl & ~0x60) | ((freqnum == 1) ? 0x40 : 0) | ((phasenum == 1) ? 0x20 : 0));
 }
 
 /*! @brief Set the signal frequency and phase.*/
 void Unit_DDS::setSleep(uint8_t level)
 {
-    uint8_t reg = readDDSReg(DDS_CTRL_ADDR);
-    reg &= (~0x18);
+    uint8_t reg = _ctrl & ~0x18;
     reg |= (level == 1) ? 0x10 : 0;
     reg |= (level == 2) ? 0x08 : 0;
-    writeDDSReg(DDS_CTRL_ADDR, 0x80 | reg);
+    writeCTRL(reg);
 }
 
 /*! @brief Reset DDS Unit.*/
 void Unit_DDS::reset()
 {
-    writeDDSReg(DDS_CTRL_ADDR, 0x80 | 0x04);
+    writeCTRL(0x04);
+}
+
+/*! @brief Number of recorded frames (at most UNIT_DDS_TRACE_SIZE).*/
+size_t Unit_DDS::traceCount() const
+{
+#if UNIT_DDS_TRACE_ENABLED
+    return _trace_head < UNIT_DDS_TRACE_SIZE ? _trace_head : UNIT_DDS_TRACE_SIZE;
+#else
+    return 0;
+#endif
+}
+
+/*! @brief Print recorded frames, oldest first. Call outside of timing-critical paths.*/
+void Unit_DDS::dumpTrace(Print& out)
+{
+#if UNIT_DDS_TRACE_ENABLED
+    const uint32_t count = traceCount();
+    for (uint32_t i = _trace_head - count; i != _trace_head; ++i) {
+        const TraceFrame& f = _trace[i & (UNIT_DDS_TRACE_SIZE - 1)];
+        out.printf("%10u %02X:", (unsigned int)f.us, f.addr);
+        for (uint8_t j = 0; j < f.size; ++j) {
+            out.printf(" %02X", f.data[j]);
+        }
+        out.printf("\r\n");
+    }
+#else
+    (void)out;
+#endif
+}
+
+/*! @brief Discard recorded frames.*/
+void Unit_DDS::clearTrace()
+{
+#if UNIT_DDS_TRACE_ENABLED
+    _trace_head = 0;
+#endif
 }
@@ -18,13 +18,52 @@
 
 #define DDS_FMCLK 10000000
 
+// Define UNIT_DDS_TRACE_SIZE (number of frames, power of 2) to record written frames into a ring buffer
+// e.g. build_flags = -DUNIT_DDS_TRACE_SIZE=32
+#if defined(UNIT_DDS_TRACE_SIZE) && (UNIT_DDS_TRACE_SIZE > 0)
+#define UNIT_DDS_TRACE_ENABLED 1
+#if (UNIT_DDS_TRACE_SIZE & (UNIT_DDS_TRACE_SIZE - 1)) != 0
+#error "UNIT_DDS_TRACE_SIZE must be power of 2"
+#endif
+#else
+#define UNIT_DDS_TRACE_ENABLED 0
+#endif
+
 class Unit_DDS {
 private:
     TwoWire* _pwire = nullptr;
+    uint8_t _ctrl   = 0;  // Shadow of CONTROL (without write flag)
+    uint8_t _mode   = 0;  // Shadow of MODE (without write flag)
     void writeDDSReg(uint8_t addr, uint8_t data);
-    void writeDDSReg(uint8_t addr, uint8_t* data, size_t size);
+    void writeDDSReg(uint8_t addr, const uint8_t* data, size_t size);
     uint8_t readDDSReg(uint8_t addr);
     void readDDSRegs(uint8_t addr, uint8_t* dataptr, uint8_t size);
+    void writeCTRL(uint8_t ctrlbyte);
+
+#if UNIT_DDS_TRACE_ENABLED
+    struct TraceFrame {
+        uint32_t us;
+        uint8_t addr;
+        uint8_t size;
+        uint8_t data[6];
+    };
+    TraceFrame _trace[UNIT_DDS_TRACE_SIZE];
+    uint32_t _trace_head = 0;  // Total number of recorded frames
+#endif
+    inline void trace(uint8_t addr, const uint8_t* data, size_t size)
+    {
+#if UNIT_DDS_TRACE_ENABLED
+        TraceFrame& f = _trace[_trace_head++ & (UNIT_DDS_TRACE_SIZE - 1)];
+        f.us          = micros();
+        f.addr        = addr;
+        f.size        = size < sizeof(f.data) ? size : sizeof(f.data);
+        memcpy(f.data, data, f.size);
+#else
+        (void)addr;
+        (void)data;
+        (void)size;
+#endif
+    }
 
 public:
     enum DDSmode {  // DDS output mode
@@ -61,6 +100,11 @@ public:
 
     void setSleep(uint8_t level);  // 1/2 1模式不输出保持最后一帧电平，2关闭时钟
     void reset();
+
+    // Trace of written frames (Enabled if UNIT_DDS_TRACE_SIZE is defined)
+    size_t traceCount() const;
+    void dumpTrace(Print& out = Serial);
+    void clearTrace();
 };
 
 #endif
@@ -0,0 +1,499 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_basic.hpp
+  @brief Bus-independent driver core for UnitDDS
+  @details The register logic is instantiated over the bus type, and the transport calls are inlined.
+  @code
+  // Arduino
+  m5::unit::dds::BasicUnitDDS<m5::unit::dds::bus::TwoWireBus> dds(Wire);
+  // In-memory simulator
+  m5::unit::dds::BasicUnitDDS<m5::unit::dds::bus::Simulator> sim;
+  if (dds.begin()) {
+      dds.writeOutput(m5::unit::dds::Mode::Sin, false, 1000, 0);
+  }
+  @endcode
+  @note Bus requirements
+  - bool write(const uint8_t reg, const uint8_t* buf, const size_t len)
+  - bool read(const uint8_t reg, uint8_t* buf, const size_t len)
+  - (Optional) uint8_t controlToWrite(const uint8_t ctrl) : the CONTROL value to write instead of ctrl
+  (e.g. bits held by the wrapper), the cache follows the written value
+*/
+#ifndef M5_UNIT_DDS_DDS_BASIC_HPP
+#define M5_UNIT_DDS_DDS_BASIC_HPP
+
+#include "dds_codec.hpp"
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+///@cond
+namespace detail {
+// Bus::controlToWrite if the bus has it
+template <class B>
+auto control_to_write(B& bus, const uint8_t ctrl, int) -> decltype(bus.controlToWrite(ctrl))
+{
+    return bus.controlToWrite(ctrl);
+}
+template <class B>
+uint8_t control_to_write(B&, const uint8_t ctrl, long)
+{
+    return ctrl;
+}
+}  // namespace detail
+///@endcond
+
+/*!
+  @class m5::unit::dds::BasicUnitDDS
+  @brief Driver core over the bus
+  @tparam Bus Bus backend (See also dds_bus.hpp, dds_simulator.hpp)
+  @details UnitDDS is this core over the M5UnitUnified component bus
+  @note No retry, locking and logging, add them in the bus or the wrapper if needed
+  @note The MODE register is cached after the first read or write and not read again,
+  so a change of MODE by another master is not picked up until readMode or resync
+ */
+template <class Bus>
+class BasicUnitDDS {
+public:
+    //! @brief Arguments are forwarded to the bus
+    template <typename... Args>
+    explicit BasicUnitDDS(Args&&... args) : _bus(std::forward<Args>(args)...)
+    {
+    }
+
+    //! @brief Gets the bus
+    inline Bus& bus()
+    {
+        return _bus;
+    }
+    //! @brief Gets the bus
+    inline const Bus& bus() const
+    {
+        return _bus;
+    }
+
+    /*!
+      @brief Check the description and read the MODE and CONTROL
+      @return True if successful
+     */
+    bool begin()
+    {
+        char desc[7]{};
+        Mode mode{};
+        uint8_t ctrl{};
+        return readDescription(desc) && std::strcmp(desc, codec::DESC) == 0 && readMode(mode) && readControl(ctrl);
+    }
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the cached mode
+    inline Mode mode() const
+    {
+        return _mode;
+    }
+    //! @brief Gets the cached CONTROL value
+    inline uint8_t control() const
+    {
+        return _ctrl;
+    }
+    //! @brief Is the cached CONTROL value valid?
+    inline bool controlValid() const
+    {
+        return _ctrl_valid;
+    }
+    //! @brief Is the cached MODE value valid?
+    inline bool modeValid() const
+    {
+        return _mode_valid;
+    }
+    //! @brief Gets written frequency (Hz)
+    inline uint32_t frequency(const bool select) const
+    {
+        return _freq[select];
+    }
+    //! @brief Gets written FTW
+    inline uint32_t frequencyWord(const bool select) const
+    {
+        return _ftw[select];
+    }
+    //! @brief Gets written phase (degree)
+    inline uint16_t phase(const bool select) const
+    {
+        return _deg[select];
+    }
+    //! @brief Gets the frequency bank in use (cached CONTROL)
+    inline bool currentFrequencyBank() const
+    {
+        return _ctrl & codec::CTRL_FSELECT;
+    }
+    //! @brief Gets the phase bank in use (cached CONTROL)
+    inline bool currentPhaseBank() const
+    {
+        return _ctrl & codec::CTRL_PSELECT;
+    }
+    ///@}
+
+    ///@name Output mode
+    ///@{
+    //! @brief Read the output mode and refresh the cached value
+    bool readMode(Mode& mode)
+    {
+        uint8_t v{};
+        if (_bus.read(command::MODE_REG, &v, 1)) {
+            _mode_reg   = v & 0x7F;
+            _mode_valid = true;
+            _mode = mode = static_cast<Mode>(v & 0x07);
+            return true;
+        }
+        return false;
+    }
+    /*!
+      @brief Write the output mode
+      @note MODE is read only if the cached value is invalid
+      @note The frequencies cleared by the firmware in Sawtooth/DC are written back when leaving them
+     */
+    inline bool writeMode(const Mode mode)
+    {
+        return syncControl() && writeModeAndControl(mode, _ctrl);
+    }
+    /*!
+      @brief Write the output mode and the whole CONTROL in a single burst
+      @note The frequencies cleared by the firmware in Sawtooth/DC are written back when leaving them
+     */
+    bool writeModeAndControl(const Mode mode, const uint8_t ctrl)
+    {
+        uint8_t v{};
+        if (!read_mode(v)) {
+            return false;
+        }
+        const Mode old = static_cast<Mode>(v & 0x07);
+        // CONTROL must also be written to reflect the mode change
+        return write_mode_control((v & ~0x07) | static_cast<uint8_t>(mode), ctrl) && restore_frequency(old, mode);
+    }
+    ///@}
+
+    ///@name Control
+    ///@{
+    //! @brief Read the CONTROL and refresh the cached value
+    bool readControl(uint8_t& ctrl)
+    {
+        if (_bus.read(command::CONTROL_REG, &ctrl, 1)) {
+            ctrl &= 0x7F;
+            _ctrl       = ctrl;
+            _ctrl_valid = true;
+            return true;
+        }
+        return false;
+    }
+    //! @brief Read the CONTROL if the cached value is invalid
+    bool syncControl()
+    {
+        uint8_t ctrl{};
+        return _ctrl_valid || readControl(ctrl);
+    }
+    //! @brief Write the whole CONTROL
+    inline bool writeControl(const uint8_t ctrl)
+    {
+        return write_control(ctrl);
+    }
+    /*!
+      @brief Rewrite the bits of mask in CONTROL with a single write
+      @note CONTROL is read only if the cached value is invalid
+     */
+    inline bool updateControl(const uint8_t mask, const uint8_t bits)
+    {
+        return syncControl() && write_control((_ctrl & ~mask) | (bits & mask));
+    }
+    ///@}
+
+    ///@name Settings
+    ///@{
+    //! @brief Write the frequency (Hz) 0 - 1MHz
+    bool writeFrequency(const bool select, const uint32_t freq)
+    {
+        if (!codec::is_valid_frequency(freq)) {
+            return false;
+        }
+        uint8_t buf[4]{};
+        const uint32_t ftw = frequency_to_ftw(freq);
+        codec::encode_ftw(buf, select, ftw);
+        return written_ftw(select, ftw, freq, _bus.write(command::FREQUENCY_REG, buf, 4));
+    }
+    //! @brief Write the raw frequency tuning word
+    bool writeFrequencyWord(const bool select, const uint32_t ftw)
+    {
+        if (!codec::is_valid_ftw(ftw)) {
+            return false;
+        }
+        uint8_t buf[4]{};
+        codec::encode_ftw(buf, select, ftw);
+        return writeFrequencyFrame(buf);
+    }
+    //! @brief Write the frequency frame encoded by codec::encode_ftw as is
+    bool writeFrequencyFrame(const uint8_t frame[4])
+    {
+        const uint32_t ftw = codec::decode_ftw(frame);
+        if (!(frame[0] & codec::WRITE_FLAG) || !codec::is_valid_ftw(ftw)) {
+            return false;
+        }
+        return written_ftw(codec::decode_select(frame[0]), ftw, ftw_to_frequency(ftw),
+                           _bus.write(command::FREQUENCY_REG, frame, 4));
+    }
+    //! @brief Write the phase (degree)
+    bool writePhase(const bool select, const uint16_t deg)
+    {
+        uint8_t buf[2]{};
+        codec::encode_phase(buf, select, deg);
+        if (_bus.write(command::PHASE_REG, buf, 2)) {
+            _deg[select] = deg;
+            return true;
+        }
+        return false;
+    }
+    //! @brief Write the frequency and phase in a single burst
+    bool writeFrequencyAndPhase(const bool select_freq, const uint32_t freq, const bool select_phase,
+                                const uint16_t deg)
+    {
+        if (!codec::is_valid_frequency(freq)) {
+            return false;
+        }
+        uint8_t buf[6]{};
+        const uint32_t ftw = frequency_to_ftw(freq);
+        codec::encode_ftw(buf, select_freq, ftw);
+        codec::encode_phase(buf + 4, select_phase, deg);
+        if (written_ftw(select_freq, ftw, freq, _bus.write(command::FREQUENCY_REG, buf, 6))) {
+            _deg[select_phase] = deg;
+            return true;
+        }
+        return false;
+    }
+    //! @brief Write which bank setting to use
+    inline bool writeCurrent(const bool select_freq, const bool select_phase)
+    {
+        return updateControl(codec::CTRL_FSELECT | codec::CTRL_PSELECT,
+                             (select_freq ? codec::CTRL_FSELECT : 0x00) | (select_phase ? codec::CTRL_PSELECT : 0x00));
+    }
+    //! @brief Write which bank frequency setting to use
+    inline bool writeCurrentFrequency(const bool select)
+    {
+        return updateControl(codec::CTRL_FSELECT, select ? codec::CTRL_FSELECT : 0x00);
+    }
+    //! @brief Write which bank phase setting to use
+    inline bool writeCurrentPhase(const bool select)
+    {
+        return updateControl(codec::CTRL_PSELECT, select ? codec::CTRL_PSELECT : 0x00);
+    }
+    ///@}
+
+    ///@name Operation
+    ///@{
+    //! @brief Write mode, frequency and phase, and use the bank
+    bool writeOutput(const Mode mode, const bool select, const uint32_t freq, const uint16_t deg)
+    {
+        return writeFrequencyAndPhase(select, freq, select, deg) && writeMode(mode) && writeCurrent(select, select);
+    }
+    //! @brief Sleep MCLK and/or DAC
+    bool sleep(const bool mclk, const bool DAC)
+    {
+        if (!mclk && !DAC) {
+            return false;
+        }
+        return updateControl(codec::CTRL_SLEEP1 | codec::CTRL_SLEEP12,
+                             (mclk ? codec::CTRL_SLEEP1 : 0x00) | (DAC ? codec::CTRL_SLEEP12 : 0x00));
+    }
+    //! @brief Wake up and release the reset
+    inline bool wakeup()
+    {
+        return updateControl(codec::CTRL_SLEEP1 | codec::CTRL_SLEEP12 | codec::CTRL_RESET, 0x00);
+    }
+    //! @brief Reset the internal registers
+    inline bool reset()
+    {
+        return updateControl(codec::CTRL_RESET, codec::CTRL_RESET);
+    }
+    /*!
+      @brief Program the whole output without reading
+      @details MODE+CONTROL with RESET, then frequency and phase in a single burst, then RESET release
+      @param mode Output mode
+      @param select Bank for frequency and phase
+      @param freq Frequency(Hz) 0 - 1Mhz
+      @param deg Phase (degree)
+      @param hold Keep RESET if true (2 transactions), release it if false (3 transactions)
+      @note SLEEP bits and the upper bits of MODE are cleared
+      @note The other bank is written back from the cache if leaving Sawtooth/DC (or the mode is unknown)
+      and its cached frequency is not 0 (1 more transaction)
+     */
+    bool program(const Mode mode, const bool select, const uint32_t freq, const uint16_t deg, const bool hold)
+    {
+        if (!codec::is_valid_frequency(freq)) {
+            return false;
+        }
+        const bool cleared = !_mode_valid || codec::is_frequency_ignored(_mode);
+        const uint8_t sel  = select ? (codec::CTRL_FSELECT | codec::CTRL_PSELECT) : 0x00;
+        // The bank is written after the mode (Sawtooth/DC clear it)
+        if (!write_mode_control(static_cast<uint8_t>(mode), sel | codec::CTRL_RESET)) {
+            return false;
+        }
+        uint8_t buf[6]{};
+        const uint32_t ftw = frequency_to_ftw(freq);
+        codec::encode_ftw(buf, select, ftw);
+        codec::encode_phase(buf + 4, select, deg);
+        if (!written_ftw(select, ftw, freq, _bus.write(command::FREQUENCY_REG, buf, 6))) {
+            return false;
+        }
+        _deg[select] = deg;
+        if (cleared && !codec::is_frequency_ignored(mode) && !restore_bank(!select)) {
+            return false;
+        }
+        return hold || write_control(sel);
+    }
+    ///@}
+
+    /*!
+      @brief Bring the unit in line with the cache after a failure
+      @details Reads CONTROL and MODE, and rewrites both banks from the cache
+      (only phases in Sawtooth/DC, the frequencies are written back by writeMode)
+      @return True if successful
+     */
+    bool resync()
+    {
+        Mode mode{};
+        uint8_t ctrl{};
+        if (!readControl(ctrl) || !readMode(mode)) {
+            _mode_valid = false;
+            return false;
+        }
+        if (codec::is_frequency_ignored(mode)) {
+            // Frequencies are written back on leaving the mode, including banks cached as 0
+            _stale = 0x03;
+            return writePhase(false, _deg[0]) && writePhase(true, _deg[1]);
+        }
+        return write_bank(false) && write_bank(true);
+    }
+
+    /*!
+      @brief Read the description
+      @param[out] str Description string buffer (at least 7 bytes)
+     */
+    bool readDescription(char str[7])
+    {
+        str[0] = '\0';
+        uint8_t rbuf[6]{};
+        if (_bus.read(command::READ_DESCRIPTION_REG, rbuf, 6)) {
+            std::memcpy(str, rbuf, 6);
+            str[6] = '\0';
+            return true;
+        }
+        return false;
+    }
+
+protected:
+    // MODE from the cache if valid
+    bool read_mode(uint8_t& v)
+    {
+        if (_mode_valid) {
+            v = _mode_reg;
+            return true;
+        }
+        Mode mode{};
+        if (readMode(mode)) {
+            v = _mode_reg;
+            return true;
+        }
+        return false;
+    }
+    // Single CONTROL write, the cache follows the written value
+    bool write_control(const uint8_t value)
+    {
+        const uint8_t ctrl = detail::control_to_write(_bus, static_cast<uint8_t>(value & 0x7F), 0) & 0x7F;
+        const uint8_t v    = ctrl | codec::WRITE_FLAG;
+        if (_bus.write(command::CONTROL_REG, &v, 1)) {
+            _ctrl       = ctrl;
+            _ctrl_valid = true;
+            return true;
+        }
+        // Unknown whether it was written
+        _ctrl_valid = false;
+        return false;
+    }
+    // MODE and CONTROL in a single burst
+    bool write_mode_control(const uint8_t mode, const uint8_t value)
+    {
+        const uint8_t ctrl   = detail::control_to_write(_bus, static_cast<uint8_t>(value & 0x7F), 0) & 0x7F;
+        const uint8_t buf[2] = {static_cast<uint8_t>(mode | codec::WRITE_FLAG),
+                                static_cast<uint8_t>(ctrl | codec::WRITE_FLAG)};
+        if (_bus.write(command::MODE_REG, buf, 2)) {
+            _mode_reg   = mode & 0x7F;
+            _mode       = static_cast<Mode>(mode & 0x07);
+            _mode_valid = true;
+            _ctrl       = ctrl;
+            _ctrl_valid = true;
+            return true;
+        }
+        _mode_valid = _ctrl_valid = false;
+        return false;
+    }
+    // Set back the frequencies cleared by the firmware when leaving Sawtooth/DC
+    // A frame per bank from the written FTW, the phase is kept by the firmware
+    bool restore_frequency(const Mode old, const Mode mode)
+    {
+        if (!codec::is_frequency_ignored(old) || codec::is_frequency_ignored(mode)) {
+            return true;
+        }
+        return restore_bank(false) && restore_bank(true);
+    }
+    // FTW of the bank from the cache
+    bool restore_bank(const bool select)
+    {
+        if (!_ftw[select] && !(_stale & (1U << select))) {
+            return true;  // Already 0
+        }
+        uint8_t buf[4]{};
+        codec::encode_ftw(buf, select, _ftw[select]);
+        return written_ftw(select, _ftw[select], _freq[select], _bus.write(command::FREQUENCY_REG, buf, 4));
+    }
+    // Frequency and phase of the bank from the cache in a single burst
+    bool write_bank(const bool select)
+    {
+        uint8_t buf[6]{};
+        codec::encode_ftw(buf, select, _ftw[select]);
+        codec::encode_phase(buf + 4, select, _deg[select]);
+        return written_ftw(select, _ftw[select], _freq[select], _bus.write(command::FREQUENCY_REG, buf, 6));
+    }
+    // Update the cached FTW, the bank is stale if the write failed (it may have been applied)
+    bool written_ftw(const bool select, const uint32_t ftw, const uint32_t freq, const bool written)
+    {
+        if (written) {
+            _ftw[select]  = ftw;
+            _freq[select] = freq;
+            _stale &= ~(1U << select);
+        } else {
+            _stale |= (1U << select);
+        }
+        return written;
+    }
+
+private:
+    Bus _bus;
+    Mode _mode{};
+    uint8_t _mode_reg{};  // MODE without the write flag
+    bool _mode_valid{};
+    uint8_t _ctrl{};  // CONTROL without the write flag
+    bool _ctrl_valid{};
+    uint32_t _ftw[2]{};
+    uint32_t _freq[2]{};  // Requested frequency of each bank (Hz)
+    uint16_t _deg[2]{};  // Written phase (degree), the phase word is always encoded from it
+    uint8_t _stale{};  // Banks whose FTW on the unit may differ from the cache
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
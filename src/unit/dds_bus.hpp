@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_bus.hpp
+  @brief Bus backends for BasicUnitDDS
+  @details Each backend is available if its framework exists
+  - TwoWireBus : Arduino TwoWire (M5_UNIT_DDS_ENABLE_TWOWIRE_BUS)
+  - IdfI2cBus : ESP-IDF i2c_master (M5_UNIT_DDS_ENABLE_IDF_BUS)
+  - LinuxI2cBus : Linux i2c-dev, see dds_bus_linux.hpp (M5_UNIT_DDS_ENABLE_LINUX_BUS)
+  @sa dds_simulator.hpp
+*/
+#ifndef M5_UNIT_DDS_DDS_BUS_HPP
+#define M5_UNIT_DDS_DDS_BUS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(ARDUINO)
+#include <Wire.h>
+#define M5_UNIT_DDS_ENABLE_TWOWIRE_BUS
+#endif
+
+#if defined(ESP_PLATFORM) && defined(__has_include)
+#if __has_include(<driver/i2c_master.h>)
+#include <driver/i2c_master.h>
+#define M5_UNIT_DDS_ENABLE_IDF_BUS
+#endif
+#endif
+
+namespace m5 {
+namespace unit {
+namespace dds {
+namespace bus {
+
+//! @brief Default I2C address
+constexpr uint8_t DEFAULT_ADDRESS{0x31};
+//! @brief Maximum length of a write transaction (register address excluded)
+constexpr size_t MAX_WRITE_SIZE{16};
+
+#if defined(M5_UNIT_DDS_ENABLE_TWOWIRE_BUS)
+/*!
+  @class m5::unit::dds::bus::TwoWireBus
+  @brief Arduino TwoWire backend
+  @note The clock and pins are set by the user (Wire.begin, Wire.setClock)
+ */
+class TwoWireBus {
+public:
+    explicit TwoWireBus(TwoWire& wire, const uint8_t addr = DEFAULT_ADDRESS) : _wire(wire), _addr(addr)
+    {
+    }
+    inline bool write(const uint8_t reg, const uint8_t* buf, const size_t len)
+    {
+        _wire.beginTransmission(_addr);
+        _wire.write(reg);
+        _wire.write(buf, len);
+        return _wire.endTransmission() == 0;
+    }
+    inline bool read(const uint8_t reg, uint8_t* buf, const size_t len)
+    {
+        _wire.beginTransmission(_addr);
+        _wire.write(reg);
+        if (_wire.endTransmission(false) != 0 ||
+            _wire.requestFrom(_addr, static_cast<uint8_t>(len)) != static_cast<uint8_t>(len)) {
+            return false;
+        }
+        for (size_t i = 0; i < len; ++i) {
+            buf[i] = _wire.read();
+        }
+        return true;
+    }
+
+private:
+    TwoWire& _wire;
+    uint8_t _addr{};
+};
+#endif
+
+#if defined(M5_UNIT_DDS_ENABLE_IDF_BUS)
+/*!
+  @class m5::unit::dds::bus::IdfI2cBus
+  @brief ESP-IDF i2c_master backend
+  @note The device is added by the user (i2c_master_bus_add_device)
+ */
+class IdfI2cBus {
+public:
+    explicit IdfI2cBus(i2c_master_dev_handle_t dev, const int timeout_ms = 50) : _dev(dev), _timeout_ms(timeout_ms)
+    {
+    }
+    inline bool write(const uint8_t reg, const uint8_t* buf, const size_t len)
+    {
+        if (len > MAX_WRITE_SIZE) {
+            return false;
+        }
+        uint8_t tmp[MAX_WRITE_SIZE + 1];
+        tmp[0] = reg;
+        std::memcpy(tmp + 1, buf, len);
+        return i2c_master_transmit(_dev, tmp, len + 1, _timeout_ms) == ESP_OK;
+    }
+    inline bool read(const uint8_t reg, uint8_t* buf, const size_t len)
+    {
+        return i2c_master_transmit_receive(_dev, &reg, 1, buf, len, _timeout_ms) == ESP_OK;
+    }
+
+private:
+    i2c_master_dev_handle_t _dev{};
+    int _timeout_ms{};
+};
+#endif
+
+}  // namespace bus
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
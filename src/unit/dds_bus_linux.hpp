@@ -0,0 +1,227 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_bus_linux.hpp
+  @brief Linux i2c-dev bus backend for BasicUnitDDS
+  @details Available on Linux with i2c-dev headers (M5_UNIT_DDS_ENABLE_LINUX_BUS is defined)
+  @code
+  m5::unit::dds::BasicUnitDDS<m5::unit::dds::bus::LinuxI2cBus> dds("/dev/i2c-1");
+  if (dds.begin()) {
+      // Frequency, phase and flip in one ioctl
+      dds.bus().beginBatch();
+      dds.writeFrequencyAndPhase(true, 1000, true, 0);
+      dds.writeCurrent(true, true);
+      dds.bus().endBatch();
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_BUS_LINUX_HPP
+#define M5_UNIT_DDS_DDS_BUS_LINUX_HPP
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/i2c-dev.h>) && __has_include(<linux/i2c.h>)
+#define M5_UNIT_DDS_ENABLE_LINUX_BUS
+#endif
+#endif
+
+#if defined(M5_UNIT_DDS_ENABLE_LINUX_BUS)
+
+#include "dds_bus.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+namespace bus {
+
+/*!
+  @struct SystemIoctl
+  @brief ioctl of the system
+ */
+struct SystemIoctl {
+    inline int ioctl(const int fd, const unsigned long request, void* arg)
+    {
+        return ::ioctl(fd, request, arg);
+    }
+};
+
+/*!
+  @class m5::unit::dds::bus::BasicLinuxI2cBus
+  @brief Linux i2c-dev backend using I2C_RDWR
+  @details A register read is a single ioctl with combined write/read messages.
+  Writes between beginBatch() and endBatch() are sent as multiple messages of a single ioctl
+  @tparam Syscall Provides int ioctl(int fd, unsigned long request, void* arg), replaceable by a fake for tests
+  @note Messages of a batch are separated by repeated START instead of STOP
+  @warning Writes in a batch report success when queued, check the result of endBatch()
+  and call BasicUnitDDS::resync() if it fails
+ */
+template <class Syscall = SystemIoctl>
+class BasicLinuxI2cBus {
+public:
+    //! @brief Maximum messages in a batch
+    static constexpr size_t MAX_BATCH{16};
+
+    /*!
+      @brief Open the device
+      @param path Device path (e.g. "/dev/i2c-1")
+      @param addr I2C address
+     */
+    explicit BasicLinuxI2cBus(const char* path, const uint8_t addr = DEFAULT_ADDRESS)
+        : _fd(::open(path, O_RDWR)), _addr(addr), _owned(true)
+    {
+    }
+    /*!
+      @brief Use the opened device
+      @param fd File descriptor, not closed by this object
+      @param addr I2C address
+      @param sys ioctl provider
+     */
+    BasicLinuxI2cBus(const int fd, const uint8_t addr, Syscall sys = Syscall{}) : _sys(sys), _fd(fd), _addr(addr)
+    {
+    }
+    ~BasicLinuxI2cBus()
+    {
+        if (_owned && _fd >= 0) {
+            ::close(_fd);
+        }
+    }
+    BasicLinuxI2cBus(const BasicLinuxI2cBus&)            = delete;
+    BasicLinuxI2cBus& operator=(const BasicLinuxI2cBus&) = delete;
+
+    ///@name Properties
+    ///@{
+    //! @brief Is the device opened?
+    inline bool isOpen() const
+    {
+        return _fd >= 0;
+    }
+    //! @brief Gets the number of ioctl calls
+    inline uint32_t syscalls() const
+    {
+        return _syscalls;
+    }
+    //! @brief Reset the number of ioctl calls
+    inline void resetSyscalls()
+    {
+        _syscalls = 0;
+    }
+    //! @brief Gets the ioctl provider
+    inline Syscall& syscall()
+    {
+        return _sys;
+    }
+    ///@}
+
+    ///@name Batch
+    ///@{
+    //! @brief Queue the following writes
+    inline void beginBatch()
+    {
+        _batching = true;
+    }
+    /*!
+      @brief Send the queued writes in a single ioctl
+      @return True if successful
+     */
+    inline bool endBatch()
+    {
+        _batching = false;
+        return flush();
+    }
+    //! @brief Gets the number of queued writes
+    inline size_t queued() const
+    {
+        return _count;
+    }
+    ///@}
+
+    ///@name Bus
+    ///@{
+    bool write(const uint8_t reg, const uint8_t* buf, const size_t len)
+    {
+        if (len > MAX_WRITE_SIZE || (_count >= MAX_BATCH && !flush())) {
+            return false;
+        }
+        uint8_t* p = _data[_count];
+        p[0]       = reg;
+        std::memcpy(p + 1, buf, len);
+        _msgs[_count].addr  = _addr;
+        _msgs[_count].flags = 0;
+        _msgs[_count].len   = static_cast<uint16_t>(len + 1);
+        _msgs[_count].buf   = p;
+        ++_count;
+        return _batching || flush();
+    }
+    bool read(const uint8_t reg, uint8_t* buf, const size_t len)
+    {
+        // Keep the order with the queued writes
+        if (!flush()) {
+            return false;
+        }
+        uint8_t r{reg};
+        i2c_msg msgs[2]{};
+        msgs[0].addr  = _addr;
+        msgs[0].flags = 0;
+        msgs[0].len   = 1;
+        msgs[0].buf   = &r;
+        msgs[1].addr  = _addr;
+        msgs[1].flags = I2C_M_RD;
+        msgs[1].len   = static_cast<uint16_t>(len);
+        msgs[1].buf   = buf;
+        return transfer(msgs, 2);
+    }
+    ///@}
+
+protected:
+    bool flush()
+    {
+        if (!_count) {
+            return true;
+        }
+        const size_t n = _count;
+        _count         = 0;
+        return transfer(_msgs, n);
+    }
+    bool transfer(i2c_msg* msgs, const size_t n)
+    {
+        i2c_rdwr_ioctl_data data{};
+        data.msgs  = msgs;
+        data.nmsgs = static_cast<uint32_t>(n);
+        ++_syscalls;
+        return _sys.ioctl(_fd, I2C_RDWR, &data) >= 0;
+    }
+
+private:
+    Syscall _sys{};
+    int _fd{-1};
+    uint8_t _addr{};
+    bool _owned{}, _batching{};
+    uint32_t _syscalls{};
+    i2c_msg _msgs[MAX_BATCH]{};
+    uint8_t _data[MAX_BATCH][MAX_WRITE_SIZE + 1]{};
+    size_t _count{};
+};
+
+template <class Syscall>
+constexpr size_t BasicLinuxI2cBus<Syscall>::MAX_BATCH;
+
+//! @brief Linux i2c-dev backend using the system ioctl
+using LinuxI2cBus = BasicLinuxI2cBus<>;
+
+}  // namespace bus
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+
+#endif
+#endif
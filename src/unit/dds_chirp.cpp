@@ -0,0 +1,205 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_chirp.cpp
+  @brief Chirp (frequency sweep) generator for UnitDDS
+*/
+#include "dds_chirp.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <cmath>
+#include <algorithm>
+
+using m5::unit::dds::codec::MAXIMUM_FREQ;
+
+namespace {
+
+constexpr uint32_t FRAC_BITS{8};    // Fraction of the accumulated FTW
+constexpr uint32_t RATIO_BITS{28};  // Fraction of the ratio per step
+
+// Linear: start + (end - start) * i / (n - 1), rounded to nearest
+void generate_linear(uint32_t* ftw, const size_t steps, const uint32_t f0, const uint32_t f1)
+{
+    const int64_t span = static_cast<int64_t>(f1) - static_cast<int64_t>(f0);
+    const int64_t div  = static_cast<int64_t>(steps - 1);
+    for (size_t i = 0; i < steps; ++i) {
+        int64_t d = span * static_cast<int64_t>(i);
+        d         = (d >= 0 ? d + div / 2 : d - div / 2) / div;
+        ftw[i]    = static_cast<uint32_t>(static_cast<int64_t>(f0) + d);
+    }
+}
+
+// Exponential: start * r^i, the fixed-point ratio r is the only floating point calculation
+void generate_exponential(uint32_t* ftw, const size_t steps, const uint32_t f0, const uint32_t f1)
+{
+    const double r       = std::pow(static_cast<double>(f1) / f0, 1.0 / static_cast<double>(steps - 1));
+    const uint64_t ratio = static_cast<uint64_t>(llround(r * (1ULL << RATIO_BITS)));
+    const uint64_t r_int = ratio >> RATIO_BITS;
+    const uint64_t r_fra = ratio & ((1ULL << RATIO_BITS) - 1);
+    constexpr uint64_t v_max{static_cast<uint64_t>(m5::unit::dds::FTW_MAX) << FRAC_BITS};
+
+    uint64_t v = static_cast<uint64_t>(f0) << FRAC_BITS;  // 36 bits at most
+    for (size_t i = 0; i < steps; ++i) {
+        ftw[i] = static_cast<uint32_t>((v + (1U << (FRAC_BITS - 1))) >> FRAC_BITS);
+        // v * r without overflow (36 + 28 bits)
+        if (r_int && v > v_max / r_int) {
+            v = v_max;
+            continue;
+        }
+        v = v * r_int + ((v * r_fra + (1ULL << (RATIO_BITS - 1))) >> RATIO_BITS);
+        v = std::min(v, v_max);
+    }
+}
+
+}  // namespace
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+Chirp::Chirp(UnitDDS& unit) : _unit(unit)
+{
+}
+
+uint32_t Chirp::measure(const uint32_t samples)
+{
+    if (!samples) {
+        return 0;
+    }
+    // The cached CONTROL is unknown after a failed write
+    uint8_t ctrl{};
+    if (!_unit.controlValid() && !_unit.readControl(ctrl)) {
+        M5_LIB_LOGE("Failed to read CONTROL");
+        return 0;
+    }
+    // Ping-pong the current frequency, the output stays as it is
+    bool bank          = _unit.currentFrequencyBank();
+    const uint32_t ftw = _unit.frequencyWord(bank);
+
+    auto start = m5::utility::micros();
+    for (uint32_t i = 0; i < samples; ++i) {
+        bank = !bank;
+        if (!_unit.writeFrequencyWord(bank, ftw) || !_unit.writeCurrentFrequency(bank)) {
+            M5_LIB_LOGE("Failed to measure");
+            return 0;
+        }
+    }
+    // Rounded up in 64-bit, elapsed + samples - 1 may not fit in 32 bits
+    const uint64_t elapsed = static_cast<uint32_t>(m5::utility::micros() - start);
+    _step_us               = static_cast<uint32_t>((elapsed + samples - 1) / samples);
+    return _step_us;
+}
+
+size_t Chirp::stepsFor(const uint32_t duration_ms, const size_t capacity) const
+{
+    if (!_step_us || capacity < 2) {
+        return 0;
+    }
+    const uint64_t step  = static_cast<uint64_t>(_step_us) + _step_us / 8;
+    const uint64_t steps = static_cast<uint64_t>(duration_ms) * 1000U / step;
+    return static_cast<size_t>(std::max<uint64_t>(2, std::min<uint64_t>(steps, capacity)));
+}
+
+bool Chirp::generate(uint32_t* ftw, const size_t steps, const uint32_t start_hz, const uint32_t end_hz,
+                     const Type type)
+{
+    if (!ftw || steps < 2) {
+        M5_LIB_LOGE("At least 2 steps are required");
+        return false;
+    }
+    if (start_hz > MAXIMUM_FREQ || end_hz > MAXIMUM_FREQ) {
+        M5_LIB_LOGE("freq must be between 0 and %u (%u/%u)", MAXIMUM_FREQ, start_hz, end_hz);
+        return false;
+    }
+    uint32_t f0 = frequency_to_ftw(start_hz);
+    uint32_t f1 = frequency_to_ftw(end_hz);
+
+    if (type == Type::Exponential) {
+        generate_exponential(ftw, steps, std::max<uint32_t>(f0, 1), std::max<uint32_t>(f1, 1));
+    } else {
+        generate_linear(ftw, steps, f0, f1);
+    }
+    // Exact end points
+    ftw[0]         = f0;
+    ftw[steps - 1] = f1;
+    return true;
+}
+
+size_t Chirp::prepare(uint32_t* buf, const size_t capacity, const uint32_t start_hz, const uint32_t end_hz,
+                      const uint32_t duration_ms, const Type type)
+{
+    _table = nullptr;
+    _steps = 0;
+    // steps * step time is the duration, which must fit in 32-bit micros
+    if (duration_ms > UINT32_MAX / 1000U) {
+        M5_LIB_LOGE("duration_ms must be less than or equal to %u (%u)", UINT32_MAX / 1000U, duration_ms);
+        return 0;
+    }
+    if (!_step_us && !measure()) {
+        return 0;
+    }
+    size_t steps = stepsFor(duration_ms, capacity);
+    if (!steps || !generate(buf, steps, start_hz, end_hz, type)) {
+        return 0;
+    }
+    _table       = buf;
+    _steps       = steps;
+    _duration_us = duration_ms * 1000U;
+    return _steps;
+}
+
+bool Chirp::play()
+{
+    _stat = statistics_t{};
+    if (!_table || _steps < 2) {
+        M5_LIB_LOGE("Not prepared");
+        return false;
+    }
+
+    uint8_t ctrl{};
+    if (!_unit.controlValid() && !_unit.readControl(ctrl)) {
+        M5_LIB_LOGE("Failed to read CONTROL");
+        return false;
+    }
+    bool bank = !_unit.currentFrequencyBank();
+    if (!_unit.writeFrequencyWord(bank, _table[0]) || !_unit.writeCurrentFrequency(bank)) {
+        ++_stat.failed;
+        return false;
+    }
+    const uint32_t start = m5::utility::micros();
+    ++_stat.steps;
+
+    for (size_t i = 1; i < _steps; ++i) {
+        // Step i starts at duration * i / steps
+        const uint32_t deadline = static_cast<uint32_t>(static_cast<uint64_t>(_duration_us) * i / _steps);
+        if (!_unit.writeFrequencyWord(!bank, _table[i])) {
+            ++_stat.failed;
+            continue;
+        }
+        uint32_t elapsed{};
+        while ((elapsed = m5::utility::micros() - start) < deadline) {
+        }
+        if (!_unit.writeCurrentFrequency(!bank)) {
+            // The flip may have been applied, follow the bank of the device
+            ++_stat.failed;
+            if (_unit.readControl(ctrl)) {
+                bank = _unit.currentFrequencyBank();
+            }
+            continue;
+        }
+        bank               = !bank;
+        _stat.max_lateness = std::max(_stat.max_lateness, elapsed - deadline);
+        ++_stat.steps;
+    }
+    // The last step lasts until the end of the duration
+    while ((_stat.duration_us = m5::utility::micros() - start) < _duration_us) {
+    }
+    return _stat.failed == 0;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_chirp.hpp
+  @brief Chirp (frequency sweep) generator for UnitDDS
+  @code
+  static uint32_t table[512];
+  m5::unit::dds::Chirp chirp(unit);
+  // 1kHz to 20kHz in 500ms, the number of steps is chosen from the bus speed
+  if (chirp.prepare(table, 512, 1000, 20000, 500, m5::unit::dds::Chirp::Type::Exponential)) {
+      chirp.play();
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_CHIRP_HPP
+#define M5_UNIT_DDS_DDS_CHIRP_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::Chirp
+  @brief Plays a precomputed FTW table through bank ping-pong
+  @details Each step writes the next FTW to the inactive bank and flips the bank at its deadline,
+  so the output switches phase-continuously with a single CONTROL write.
+  The table is computed once with integer math and stored in the caller's buffer.
+ */
+class Chirp {
+public:
+    /*!
+      @enum Type
+      @brief Sweep curve
+     */
+    enum class Type : uint8_t {
+        Linear,       //!< Constant Hz per step
+        Exponential,  //!< Constant ratio per step (logarithmic sweep)
+    };
+
+    /*!
+      @struct statistics_t
+      @brief Result of the last play()
+     */
+    struct statistics_t {
+        uint32_t steps{};         //!< Number of steps played
+        uint32_t failed{};        //!< Number of steps dropped by I2C failure
+        uint32_t max_lateness{};  //!< Maximum lateness of the flips (us)
+        uint32_t duration_us{};   //!< Measured duration (us)
+    };
+
+    explicit Chirp(UnitDDS& unit);
+
+    /*!
+      @brief Measure the time of one step on the current bus
+      @param samples Number of steps to measure
+      @return Time of one step (us), 0 if failed
+      @note The current frequency is rewritten to the other bank, the output does not change
+     */
+    uint32_t measure(const uint32_t samples = 8);
+    /*!
+      @brief Number of steps for the duration
+      @param duration_ms Duration (ms)
+      @param capacity Upper limit
+      @return Number of steps (2 - capacity), 0 if the step time is unknown
+      @note Keeps 1/8 of the measured step time as a margin for jitter
+     */
+    size_t stepsFor(const uint32_t duration_ms, const size_t capacity) const;
+
+    /*!
+      @brief Fill the FTW table
+      @param ftw Table
+      @param steps Number of steps (at least 2)
+      @param start_hz Start frequency (Hz) 0 - 1MHz
+      @param end_hz End frequency (Hz) 0 - 1MHz
+      @param type Sweep curve
+      @return True if successful
+      @note The first and last entries are exactly the start and end frequencies
+      @note Exponential treats 0 Hz as the lowest FTW (1)
+     */
+    static bool generate(uint32_t* ftw, const size_t steps, const uint32_t start_hz, const uint32_t end_hz,
+                         const Type type = Type::Linear);
+
+    /*!
+      @brief Prepare the chirp
+      @details Measures the step time if not yet, chooses the number of steps and fills the table
+      @param buf Table (must be alive until play() is done)
+      @param capacity Number of entries of buf
+      @param start_hz Start frequency (Hz) 0 - 1MHz
+      @param end_hz End frequency (Hz) 0 - 1MHz
+      @param duration_ms Duration (ms)
+      @param type Sweep curve
+      @return Number of steps, 0 if failed
+     */
+    size_t prepare(uint32_t* buf, const size_t capacity, const uint32_t start_hz, const uint32_t end_hz,
+                   const uint32_t duration_ms, const Type type = Type::Linear);
+    /*!
+      @brief Play the prepared chirp
+      @return True if all steps are played
+      @note Blocks for the duration, the end frequency remains on output
+     */
+    bool play();
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the time of one step (us), 0 if not measured
+    inline uint32_t stepTime() const
+    {
+        return _step_us;
+    }
+    //! @brief Set the time of one step (us) instead of measure()
+    inline void stepTime(const uint32_t us)
+    {
+        _step_us = us;
+    }
+    //! @brief Gets the number of prepared steps
+    inline size_t steps() const
+    {
+        return _steps;
+    }
+    //! @brief Gets the result of the last play()
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    ///@}
+
+private:
+    UnitDDS& _unit;
+    const uint32_t* _table{};
+    size_t _steps{};
+    uint32_t _duration_us{};
+    uint32_t _step_us{};
+    statistics_t _stat{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_clock.cpp
+  @brief I2C clock autotuning for UnitDDS
+*/
+#include "dds_clock.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+constexpr size_t ClockTuner::MAX_STEPS;
+
+namespace {
+// Transactions of a trial of UnitDDS::probeLink
+constexpr uint32_t TRANSACTIONS_PER_TRIAL{4};
+}  // namespace
+
+bool ClockTuner::tune(UnitDDS* const* units, const size_t count)
+{
+    _steps        = 0;
+    _clock        = 0;
+    _failed_clock = 0;
+    for (auto&& r : _result) {
+        r = result_t{};
+    }
+    if (!_set_clock || !units || !count || !_cfg.clocks[0]) {
+        M5_LIB_LOGE("No callback, units or clocks");
+        return false;
+    }
+
+    // Baseline of the shadow at the current clock
+    std::vector<Mode> modes(count);
+    std::vector<uint8_t> ctrls(count);
+    for (size_t u = 0; u < count; ++u) {
+        if (!units[u] || !units[u]->readMode(modes[u]) || !units[u]->readControl(ctrls[u])) {
+            M5_LIB_LOGE("Failed to read %zu", u);
+            return false;
+        }
+    }
+
+    bool any_error{};
+    size_t reliable{};  // Number of reliable clocks from the first
+    while (_steps < MAX_STEPS && _cfg.clocks[_steps]) {
+        auto& r = _result[_steps++];
+        r.clock = _cfg.clocks[_steps - 1];
+        if (!_set_clock(r.clock) || !probe(units, count, r) || r.errors) {
+            any_error     = true;
+            _failed_clock = r.clock;
+            break;
+        }
+        ++reliable;
+    }
+
+    const bool ok      = reliable > 0;
+    const size_t index = ok ? reliable - 1 - std::min<size_t>(_cfg.guard_steps, reliable - 1) : 0;
+    _clock             = _cfg.clocks[index];
+    if (!_set_clock(_clock)) {
+        M5_LIB_LOGE("Failed to set %u", _clock);
+        return false;
+    }
+    for (size_t u = 0; u < count; ++u) {
+        auto ccfg  = units[u]->component_config();
+        ccfg.clock = _clock;
+        units[u]->component_config(ccfg);
+        // Rewrite what a garbled transaction may have changed, MODE and CONTROL from the baseline
+        // (resync takes them from the unit as they are), then the banks, and check the link
+        uint32_t errors{};
+        if (any_error && !(units[u]->writeModeAndControl(modes[u], ctrls[u]) && units[u]->resync() &&
+                           units[u]->probeLink(1, errors) && !errors)) {
+            M5_LIB_LOGE("Failed to resync %zu", u);
+            return false;
+        }
+    }
+    return ok;
+}
+
+bool ClockTuner::probe(UnitDDS* const* units, const size_t count, result_t& result)
+{
+    const auto start = m5::utility::micros();
+    for (size_t u = 0; u < count; ++u) {
+        uint32_t errors{};
+        if (!units[u]->probeLink(_cfg.trials, errors)) {
+            return false;
+        }
+        result.errors += errors;
+        result.transactions += _cfg.trials * TRANSACTIONS_PER_TRIAL;
+    }
+    const uint32_t elapsed = m5::utility::micros() - start;
+    result.transaction_us  = result.transactions ? elapsed / result.transactions : 0;
+    return true;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_clock.hpp
+  @brief I2C clock autotuning for UnitDDS
+  @details Every bank switch and sweep step is an I2C transaction, its time is mostly set by the SCL clock.
+  @code
+  // The bus clock belongs to the driver, so it is changed by the callback
+  m5::unit::dds::ClockTuner tuner([](const uint32_t clock) {
+      Wire.setClock(clock);
+      return true;
+  });
+  if (tuner.tune(unit)) {
+      M5_LOGI("%u Hz, margin %u Hz", tuner.clock(), tuner.margin());
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_CLOCK_HPP
+#define M5_UNIT_DDS_DDS_CLOCK_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::ClockTuner
+  @brief Picks the fastest reliable I2C clock of the units on a bus
+  @details The clocks are probed from the slowest with UnitDDS::probeLink, and probing stops at the first clock
+  with an error. The fastest clock without error (less guard_steps) is set and stored in the component config
+  of each unit. If any error occurred while probing, MODE and CONTROL read before probing are written back
+  and the unit is resynchronized.
+  @note The clock is a property of the bus, not of each unit. It applies to every device on the bus,
+  including devices other than UnitDDS, so tune all units on the bus together and make sure the other
+  devices support the clock range. All units must be on the bus whose clock is changed by the callback
+ */
+class ClockTuner {
+public:
+    //! @brief Maximum number of clocks
+    static constexpr size_t MAX_STEPS{8};
+
+    /*!
+      @brief Changes the I2C clock of the bus
+      @param clock Clock (Hz)
+      @return True if successful
+     */
+    using set_clock_function_t = std::function<bool(const uint32_t clock)>;
+
+    /*!
+      @struct config_t
+      @brief Settings for tune
+     */
+    struct config_t {
+        //! Clocks to probe in ascending order (Hz), 0 terminates
+        uint32_t clocks[MAX_STEPS]{100 * 1000U, 400 * 1000U, 600 * 1000U, 800 * 1000U, 1000 * 1000U};
+        uint32_t trials{16};     //!< Trials of UnitDDS::probeLink per unit and clock
+        uint8_t guard_steps{0};  //!< Steps below the fastest reliable clock to use as the margin
+    };
+
+    /*!
+      @struct result_t
+      @brief Result of a clock
+     */
+    struct result_t {
+        uint32_t clock{};           //!< Clock (Hz)
+        uint32_t transactions{};    //!< Number of probed transactions (0 if not probed)
+        uint32_t errors{};          //!< Number of failed transactions and mismatches
+        uint32_t transaction_us{};  //!< Average time of a transaction (us)
+    };
+
+    explicit ClockTuner(set_clock_function_t set_clock) : _set_clock(set_clock)
+    {
+    }
+
+    ///@name Settings
+    ///@{
+    //! @brief Gets the configration
+    inline config_t config() const
+    {
+        return _cfg;
+    }
+    //! @brief Set the configration
+    inline void config(const config_t& cfg)
+    {
+        _cfg = cfg;
+    }
+    ///@}
+
+    /*!
+      @brief Probe the clocks and set the fastest reliable one
+      @param units Units on the bus
+      @param count Number of units
+      @return True if a clock is reliable for all units
+      @note Falls back to the first clock if none is reliable
+     */
+    bool tune(UnitDDS* const* units, const size_t count);
+    //! @brief Probe the clocks for the unit
+    inline bool tune(UnitDDS& unit)
+    {
+        UnitDDS* units[1] = {&unit};
+        return tune(units, 1);
+    }
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the clock set by the last tune (Hz)
+    inline uint32_t clock() const
+    {
+        return _clock;
+    }
+    /*!
+      @brief Gets the error margin of the last tune (Hz)
+      @details Distance from the set clock to the first clock with an error,
+      0 if every probed clock was reliable (the limit is above the probed range)
+     */
+    inline uint32_t margin() const
+    {
+        return _failed_clock ? _failed_clock - _clock : 0;
+    }
+    //! @brief Gets the first clock with an error, 0 if none (Hz)
+    inline uint32_t failedClock() const
+    {
+        return _failed_clock;
+    }
+    //! @brief Gets the number of the probed clocks
+    inline size_t steps() const
+    {
+        return _steps;
+    }
+    //! @brief Gets the result of the probed clock
+    inline const result_t& result(const size_t index) const
+    {
+        return _result[index < MAX_STEPS ? index : MAX_STEPS - 1];
+    }
+    ///@}
+
+protected:
+    bool probe(UnitDDS* const* units, const size_t count, result_t& result);
+
+private:
+    set_clock_function_t _set_clock{};
+    config_t _cfg{};
+    result_t _result[MAX_STEPS]{};
+    size_t _steps{};
+    uint32_t _clock{}, _failed_clock{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -0,0 +1,129 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_codec.hpp
+  @brief Register map and frame encoding of UnitDDS
+  @details Shared by UnitDDS and BasicUnitDDS, no dependency on the bus
+*/
+#ifndef M5_UNIT_DDS_DDS_CODEC_HPP
+#define M5_UNIT_DDS_DDS_CODEC_HPP
+
+#include "dds_ftw.hpp"
+#include <cstdint>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+/*!
+  @enum Mode
+  @brief Output mode
+ */
+enum class Mode : uint8_t {
+    Reserved,  //!< Reserved
+    Sin,       //!< Sin wave
+    Triangle,  //!< Triangle wave
+    Square,    //!< Square wave
+    Sawtooth,  //!< Sawtooth wave (M5 extension)
+               //!< Fixed at frequency 13600 and phase 0
+    DC,        //!< DC (M5 extension)
+};
+
+namespace command {
+///@cond
+constexpr uint8_t READ_DESCRIPTION_REG{0x10};
+constexpr uint8_t MODE_REG{0x20};
+constexpr uint8_t CONTROL_REG{0x21};
+constexpr uint8_t FREQUENCY_REG{0x30};
+constexpr uint8_t PHASE_REG{0x34};
+///@endcond
+}  // namespace command
+
+/*!
+  @namespace codec
+  @brief Frame encoding
+ */
+namespace codec {
+///@cond
+constexpr char DESC[] = "ad9833";
+constexpr uint32_t MINIMUM_FREQ{0};
+constexpr uint32_t MAXIMUM_FREQ{1000000};
+
+// MODE and CONTROL are written with this flag
+constexpr uint8_t WRITE_FLAG{0x80};
+
+// CONTROL bits
+constexpr uint8_t CTRL_FSELECT{0x40};
+constexpr uint8_t CTRL_PSELECT{0x20};
+constexpr uint8_t CTRL_SLEEP1{0x10};   // MCLK
+constexpr uint8_t CTRL_SLEEP12{0x08};  // DAC
+constexpr uint8_t CTRL_RESET{0x04};
+///@endcond
+
+//! @brief Frequency frame with bank select (4 bytes)
+inline void encode_ftw(uint8_t buf[4], const bool select, const uint32_t ftw)
+{
+    buf[0] = ((ftw >> 24) & 0x0F) | (select ? 0xC0 : 0x80);
+    buf[1] = (ftw >> 16) & 0xFF;
+    buf[2] = (ftw >> 8) & 0xFF;
+    buf[3] = ftw & 0xFF;
+}
+
+//! @brief FTW of the frequency frame
+constexpr uint32_t decode_ftw(const uint8_t buf[4])
+{
+    return (static_cast<uint32_t>(buf[0] & 0x0F) << 24) | (static_cast<uint32_t>(buf[1]) << 16) |
+           (static_cast<uint32_t>(buf[2]) << 8) | buf[3];
+}
+
+//! @brief Bank of the frequency/phase frame
+constexpr bool decode_select(const uint8_t buf0)
+{
+    return buf0 & 0x40;
+}
+
+//! @brief Phase frame of the phase word with bank select (2 bytes)
+inline void encode_phase_word(uint8_t buf[2], const bool select, const uint16_t ph)
+{
+    buf[0] = ((ph >> 8) & 0x07) | (select ? 0xC0 : 0x80);
+    buf[1] = ph & 0xFF;
+}
+
+//! @brief Phase frame with bank select (2 bytes)
+inline void encode_phase(uint8_t buf[2], const bool select, const uint16_t deg)
+{
+    encode_phase_word(buf, select, degree_to_phase(deg));
+}
+
+//! @brief Are frequency and phase ignored in the mode?
+constexpr bool is_frequency_ignored(const Mode m)
+{
+    return m == Mode::Sawtooth || m == Mode::DC;
+}
+
+//! @brief Is the frequency in range?
+constexpr bool is_valid_frequency(const uint32_t freq)
+{
+    return freq <= MAXIMUM_FREQ;
+}
+
+//! @brief Is the value a selectable mode (Sin - DC)?
+constexpr bool is_valid_mode(const uint8_t m)
+{
+    return m >= static_cast<uint8_t>(Mode::Sin) && m <= static_cast<uint8_t>(Mode::DC);
+}
+
+//! @brief Is the FTW in range?
+constexpr bool is_valid_ftw(const uint32_t ftw)
+{
+    return ftw <= frequency_to_ftw(MAXIMUM_FREQ);
+}
+
+}  // namespace codec
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -0,0 +1,189 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_coroutine.hpp
+  @brief C++20 coroutine support for UnitDDS
+  @details Available if C++20 or later and <coroutine> exists (M5_UNIT_DDS_ENABLE_COROUTINE is defined)
+  @code
+  m5::unit::dds::Sequence sweep(m5::unit::UnitDDS& u)
+  {
+      for (uint32_t f = 1000; f <= 10000; f += 1000) {
+          co_await u.writeFrequencyAsync(false, f);
+          co_await m5::unit::dds::after(100);
+      }
+  }
+  unit.run(sweep(unit)); // Driven by Units.update()
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_COROUTINE_HPP
+#define M5_UNIT_DDS_DDS_COROUTINE_HPP
+
+#if __cplusplus >= 202002L
+#if __has_include(<coroutine>)
+#define M5_UNIT_DDS_ENABLE_COROUTINE
+#endif
+#endif
+
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+
+#include <M5Utility.hpp>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+/*!
+  @class m5::unit::dds::Sequence
+  @brief Coroutine type for waveform sequences
+  @details Suspended at creation, resumed by UnitDDS::update() after UnitDDS::run()
+ */
+class Sequence {
+public:
+    ///@cond
+    struct promise_type {
+        unsigned long since{};  // Suspended time (ms)
+        uint32_t wait{};        // Resume after (ms)
+
+        Sequence get_return_object() noexcept
+        {
+            return Sequence{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void() noexcept
+        {
+        }
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+    using handle_t = std::coroutine_handle<promise_type>;
+    ///@endcond
+
+    Sequence() = default;
+    explicit Sequence(handle_t h) : _h(h)
+    {
+    }
+    Sequence(const Sequence&)            = delete;
+    Sequence& operator=(const Sequence&) = delete;
+    Sequence(Sequence&& o) noexcept : _h(std::exchange(o._h, nullptr))
+    {
+    }
+    Sequence& operator=(Sequence&& o) noexcept
+    {
+        if (this != &o) {
+            destroy();
+            _h = std::exchange(o._h, nullptr);
+        }
+        return *this;
+    }
+    ~Sequence()
+    {
+        destroy();
+    }
+
+    //! @brief Is the sequence finished?
+    inline bool done() const
+    {
+        return !_h || _h.done();
+    }
+    /*!
+      @brief Resume if the waiting time has elapsed
+      @param now Current time (ms)
+      @return True if still running
+     */
+    bool resume(const unsigned long now)
+    {
+        if (done()) {
+            return false;
+        }
+        // Keep the handle locally, this object may be moved while resuming
+        auto h  = _h;
+        auto& p = h.promise();
+        if (now - p.since >= p.wait) {
+            h.resume();
+        }
+        return !h.done();
+    }
+
+private:
+    void destroy()
+    {
+        if (_h) {
+            _h.destroy();
+            _h = nullptr;
+        }
+    }
+    handle_t _h{};
+};
+
+/*!
+  @struct m5::unit::dds::Delay
+  @brief Awaitable that resumes after the specified time
+ */
+struct Delay {
+    uint32_t ms{};
+    bool await_ready() const noexcept
+    {
+        return ms == 0;
+    }
+    void await_suspend(Sequence::handle_t h) const noexcept
+    {
+        h.promise().since = m5::utility::millis();
+        h.promise().wait  = ms;
+    }
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/*!
+  @struct m5::unit::dds::Invoke
+  @brief Awaitable that calls the function on the next update and returns its result
+  @tparam F Function returning the result
+ */
+template <typename F>
+struct Invoke {
+    F func;
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    void await_suspend(Sequence::handle_t h) const noexcept
+    {
+        h.promise().wait = 0;
+    }
+    auto await_resume()
+    {
+        return func();
+    }
+};
+
+/*!
+  @brief Suspend the sequence
+  @param ms Time to suspend (ms)
+ */
+inline Delay after(const uint32_t ms)
+{
+    return Delay{ms};
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+
+#endif
+#endif
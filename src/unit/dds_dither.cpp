@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_dither.cpp
+  @brief Frequency dithering between adjacent FTWs for UnitDDS
+*/
+#include "dds_dither.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <algorithm>
+
+using m5::unit::dds::codec::MAXIMUM_FREQ;
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+Dither::Dither(UnitDDS& unit) : _unit(unit)
+{
+}
+
+bool Dither::start(const uint32_t millihertz, const uint32_t interval_us)
+{
+    _active = false;
+    _stat   = statistics_t{};
+    if (millihertz > MAXIMUM_FREQ * 1000U) {
+        M5_LIB_LOGE("freq must be between 0 and %u mHz (%u)", MAXIMUM_FREQ * 1000U, millihertz);
+        return false;
+    }
+    uint16_t frac{};
+    split(millihertz, _ftw, frac);
+    if (!_unit.writeFrequencyWord(false, _ftw) || !_unit.writeFrequencyWord(true, frac ? _ftw + 1 : _ftw) ||
+        !_unit.writeCurrentFrequency(false)) {
+        ++_stat.failed;
+        return false;
+    }
+    _sd.reset(frac);
+    _interval_us = interval_us;
+    _last        = m5::utility::micros();
+    _active      = true;
+    return true;
+}
+
+bool Dither::update()
+{
+    if (!_active) {
+        return true;
+    }
+    const uint32_t now = m5::utility::micros();
+    const uint32_t dt  = now - _last;
+    if (dt < _interval_us) {
+        return true;
+    }
+    _last            = now;
+    const bool upper = _sd.upper();
+    (upper ? _stat.upper_us : _stat.lower_us) += dt;
+
+    if (_sd.next(dt) == upper) {
+        return true;
+    }
+    if (!_unit.writeCurrentFrequency(!upper)) {
+        // Stays on the current bank as far as known
+        _sd.select(upper);
+        ++_stat.failed;
+        return false;
+    }
+    ++_stat.switches;
+    return true;
+}
+
+uint32_t Dither::averageMillihertz() const
+{
+    const uint64_t total = _stat.lower_us + _stat.upper_us;
+    if (!total) {
+        return to_millihertz(_ftw, _sd.fraction());
+    }
+    return to_millihertz(_ftw, static_cast<uint16_t>(std::min<uint64_t>((_stat.upper_us << 16) / total, 0xFFFF)));
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
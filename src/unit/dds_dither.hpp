@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_dither.hpp
+  @brief Frequency dithering between adjacent FTWs for UnitDDS
+  @details One FTW step is MCLK / 2^28 (about 37 mHz). The two adjacent FTWs are written to bank 0 and 1,
+  and FSELECT is toggled so the time-averaged frequency matches the target with 1 mHz resolution.
+  @code
+  m5::unit::dds::Dither dither(unit);
+  dither.start(1000012);  // 1000.012 Hz
+  while (running) {
+      dither.update();
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_DITHER_HPP
+#define M5_UNIT_DDS_DDS_DITHER_HPP
+
+#include "dds_ftw.hpp"
+#include <cstdint>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::SigmaDelta
+  @brief First-order sigma-delta over the elapsed time
+  @details Integrates the deviation of the selected FTW from the target for the time actually spent,
+  and selects the upper FTW while the average is below the target.
+  Irregular update intervals are absorbed, the error of the average is bounded by one interval.
+ */
+class SigmaDelta {
+public:
+    //! @brief Fraction of the FTW step in Q16
+    explicit SigmaDelta(const uint16_t frac = 0) : _frac(frac)
+    {
+    }
+
+    //! @brief Restart with the fraction, the lower FTW is selected
+    inline void reset(const uint16_t frac)
+    {
+        _frac  = frac;
+        _err   = 0;
+        _upper = false;
+    }
+    /*!
+      @brief Account the elapsed time and select the next FTW
+      @param dt Time spent with the current selection
+      @return True if the upper FTW is selected
+     */
+    inline bool next(const uint32_t dt)
+    {
+        _err += (_upper ? static_cast<int64_t>(0x10000 - _frac) : -static_cast<int64_t>(_frac)) * dt;
+        _upper = _err < 0;
+        return _upper;
+    }
+    //! @brief Override the selection (e.g. the switch failed)
+    inline void select(const bool upper)
+    {
+        _upper = upper;
+    }
+    //! @brief Is the upper FTW selected?
+    inline bool upper() const
+    {
+        return _upper;
+    }
+    //! @brief Gets the fraction (Q16)
+    inline uint16_t fraction() const
+    {
+        return _frac;
+    }
+
+private:
+    uint16_t _frac{};
+    int64_t _err{};  // Accumulated deviation from the target (FTW/65536 * time)
+    bool _upper{};
+};
+
+/*!
+  @class m5::unit::dds::Dither
+  @brief Dithers FSELECT of the unit
+  @details Driven by update() without blocking, a CONTROL write is issued only when the selection changes.
+  @warning Both frequency banks are used while dithering
+ */
+class Dither {
+public:
+    /*!
+      @struct statistics_t
+      @brief Result of the dithering since start()
+     */
+    struct statistics_t {
+        uint32_t switches{};  //!< Number of FSELECT writes
+        uint32_t failed{};    //!< Number of writes failed by I2C
+        uint64_t lower_us{};  //!< Time on the lower FTW (us)
+        uint64_t upper_us{};  //!< Time on the upper FTW (us)
+    };
+
+    /*!
+      @brief Split the frequency into the FTW and the fraction of the next step
+      @param millihertz Frequency (mHz)
+      @param[out] ftw Lower FTW
+      @param[out] frac Fraction to the upper FTW (Q16)
+     */
+    static void split(const uint32_t millihertz, uint32_t& ftw, uint16_t& frac)
+    {
+        constexpr uint64_t div{static_cast<uint64_t>(MCLK_HZ) * 1000U};
+        const uint64_t v = static_cast<uint64_t>(millihertz) << 28;  // 58 bits at most
+        ftw              = static_cast<uint32_t>(v / div);
+        frac             = static_cast<uint16_t>(((v % div) << 16) / div);
+    }
+    /*!
+      @brief Frequency of the FTW with the fraction
+      @param ftw FTW
+      @param frac Fraction to the next FTW (Q16)
+      @return Frequency (mHz) rounded to nearest
+     */
+    static uint32_t to_millihertz(const uint32_t ftw, const uint16_t frac)
+    {
+        constexpr uint64_t mul{static_cast<uint64_t>(MCLK_HZ) * 1000U};
+        const uint64_t i = static_cast<uint64_t>(ftw) * mul;                // 52 bits at most
+        const uint64_t f = (static_cast<uint64_t>(frac) * mul + (1U << 15)) >> 16;  // 50 bits at most
+        return static_cast<uint32_t>((i + f + (1U << 27)) >> 28);
+    }
+
+    explicit Dither(UnitDDS& unit);
+
+    /*!
+      @brief Start dithering
+      @param millihertz Target frequency (mHz) 0 - 1MHz
+      @param interval_us Minimum interval of the selection (us)
+      @return True if successful
+      @note Writes the lower FTW to bank 0 and the upper to bank 1, and selects bank 0
+     */
+    bool start(const uint32_t millihertz, const uint32_t interval_us = 1000);
+    /*!
+      @brief Update the selection
+      @return False if the CONTROL write failed
+      @note Call as often as possible, more frequent calls reduce the error of short-term averages
+     */
+    bool update();
+    //! @brief Stop dithering, the current bank remains
+    inline void stop()
+    {
+        _active = false;
+    }
+
+    ///@name Properties
+    ///@{
+    //! @brief Is dithering?
+    inline bool isActive() const
+    {
+        return _active;
+    }
+    //! @brief Gets the lower FTW
+    inline uint32_t ftw() const
+    {
+        return _ftw;
+    }
+    //! @brief Gets the fraction to the upper FTW (Q16)
+    inline uint16_t fraction() const
+    {
+        return _sd.fraction();
+    }
+    //! @brief Gets the time-averaged frequency since start() (mHz)
+    uint32_t averageMillihertz() const;
+    //! @brief Gets the statistics
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    ///@}
+
+private:
+    UnitDDS& _unit;
+    SigmaDelta _sd{};
+    uint32_t _ftw{}, _interval_us{};
+    uint32_t _last{};
+    bool _active{};
+    statistics_t _stat{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
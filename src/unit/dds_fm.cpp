@@ -0,0 +1,237 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_fm.cpp
+  @brief Software FM modulator for UnitDDS
+*/
+#include "dds_fm.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <cmath>
+#include <algorithm>
+
+using m5::unit::dds::codec::MAXIMUM_FREQ;
+
+namespace {
+
+constexpr int32_t WAVE_MAX{32767};
+constexpr double PI{3.14159265358979323846};
+
+// Modulating value of sample i in n (-WAVE_MAX - WAVE_MAX)
+int32_t wave_value(const m5::unit::dds::FM::Waveform waveform, const size_t i, const size_t n)
+{
+    if (waveform == m5::unit::dds::FM::Waveform::Triangle) {
+        // 0 -> +max -> 0 -> -max over the period
+        const int64_t q = static_cast<int64_t>(i) * 4 * WAVE_MAX / static_cast<int64_t>(n);  // 0 - 4max
+        const int64_t v = q < WAVE_MAX ? q : (q < 3 * WAVE_MAX ? 2 * WAVE_MAX - q : q - 4 * WAVE_MAX);
+        return static_cast<int32_t>(v);
+    }
+    const double rad = 2.0 * PI * static_cast<double>(i) / static_cast<double>(n);
+    return static_cast<int32_t>(lround(WAVE_MAX * std::sin(rad)));
+}
+
+// FTW of carrier + deviation * v / WAVE_MAX, the frequency is summed in mHz before the conversion
+uint32_t modulated_ftw(const uint32_t carrier_hz, const uint32_t deviation_hz, const int32_t v)
+{
+    int64_t d          = static_cast<int64_t>(deviation_hz) * 1000 * v;
+    d                  = (d >= 0 ? d + WAVE_MAX / 2 : d - WAVE_MAX / 2) / WAVE_MAX;
+    const uint64_t mhz = static_cast<uint64_t>(static_cast<int64_t>(carrier_hz) * 1000 + d);
+    constexpr uint64_t div{static_cast<uint64_t>(m5::unit::dds::MCLK_HZ) * 1000U};
+    return static_cast<uint32_t>(((mhz << 28) + div / 2) / div);
+}
+
+bool validate(const m5::unit::dds::FM::Frame* frames, const size_t samples, const uint32_t carrier_hz,
+              const uint32_t deviation_hz)
+{
+    if (!frames || samples < 2 || (samples & 1)) {
+        M5_LIB_LOGE("Even number of samples (at least 2) is required (%zu)", samples);
+        return false;
+    }
+    // Both ends, carrier - deviation and carrier + deviation
+    if (deviation_hz > carrier_hz || static_cast<uint64_t>(carrier_hz) + deviation_hz > MAXIMUM_FREQ) {
+        M5_LIB_LOGE("carrier +- deviation must be between 0 and %u (%u/%u)", MAXIMUM_FREQ, carrier_hz,
+                    deviation_hz);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+FM::FM(UnitDDS& unit) : _unit(unit)
+{
+}
+
+uint32_t FM::measure(const uint32_t samples)
+{
+    if (!samples) {
+        return 0;
+    }
+    // The cached CONTROL is unknown after a failed write
+    uint8_t ctrl{};
+    if (!_unit.controlValid() && !_unit.readControl(ctrl)) {
+        M5_LIB_LOGE("Failed to read CONTROL");
+        return 0;
+    }
+    // Ping-pong the current frequency, the output stays as it is
+    bool bank          = _unit.currentFrequencyBank();
+    const uint32_t ftw = _unit.frequencyWord(bank);
+
+    Frame f{};
+    auto start = m5::utility::micros();
+    for (uint32_t i = 0; i < samples; ++i) {
+        bank = !bank;
+        codec::encode_ftw(f.data, bank, ftw);
+        if (!_unit.writeFrequencyFrame(f.data) || !_unit.writeCurrentFrequency(bank)) {
+            M5_LIB_LOGE("Failed to measure");
+            return 0;
+        }
+    }
+    // Rounded up in 64-bit, elapsed + samples - 1 may not fit in 32 bits
+    const uint64_t elapsed = static_cast<uint32_t>(m5::utility::micros() - start);
+    _sample_us             = static_cast<uint32_t>((elapsed + samples - 1) / samples);
+    return _sample_us;
+}
+
+bool FM::generate(Frame* frames, const size_t samples, const uint32_t carrier_hz, const uint32_t deviation_hz,
+                  const Waveform waveform)
+{
+    if (!validate(frames, samples, carrier_hz, deviation_hz)) {
+        return false;
+    }
+    for (size_t i = 0; i < samples; ++i) {
+        codec::encode_ftw(frames[i].data, i & 1, modulated_ftw(carrier_hz, deviation_hz, wave_value(waveform, i, samples)));
+    }
+    return true;
+}
+
+bool FM::generate(Frame* frames, const int16_t* wave, const size_t samples, const uint32_t carrier_hz,
+                  const uint32_t deviation_hz)
+{
+    if (!wave || !validate(frames, samples, carrier_hz, deviation_hz)) {
+        return false;
+    }
+    for (size_t i = 0; i < samples; ++i) {
+        const int32_t v = std::max<int32_t>(wave[i], -WAVE_MAX);
+        codec::encode_ftw(frames[i].data, i & 1, modulated_ftw(carrier_hz, deviation_hz, v));
+    }
+    return true;
+}
+
+size_t FM::prepare(Frame* buf, const size_t capacity, const uint32_t carrier_hz, const uint32_t deviation_hz,
+                   const uint32_t modulation_hz, const Waveform waveform)
+{
+    _table   = nullptr;
+    _samples = 0;
+    if (!modulation_hz) {
+        M5_LIB_LOGE("modulation_hz must be greater than 0");
+        return 0;
+    }
+    if (!_sample_us && !measure()) {
+        return 0;
+    }
+    // As many samples as the bus sustains in one period
+    const uint64_t sample = static_cast<uint64_t>(_sample_us) + _sample_us / 8;
+    uint64_t n            = 1000000ULL / (modulation_hz * sample);
+    n                     = std::min<uint64_t>(n, capacity) & ~1ULL;
+    if (n < 2) {
+        M5_LIB_LOGE("Too fast modulation for the bus (%u Hz, %u us/sample)", modulation_hz, _sample_us);
+        return 0;
+    }
+    if (!generate(buf, static_cast<size_t>(n), carrier_hz, deviation_hz, waveform)) {
+        return 0;
+    }
+    _table         = buf;
+    _samples       = static_cast<size_t>(n);
+    _modulation_hz = modulation_hz;
+    return _samples;
+}
+
+bool FM::use(const Frame* frames, const size_t samples, const uint32_t modulation_hz)
+{
+    _table   = nullptr;
+    _samples = 0;
+    if (!frames || samples < 2 || (samples & 1) || !modulation_hz) {
+        M5_LIB_LOGE("Invalid table %p %zu %u", frames, samples, modulation_hz);
+        return false;
+    }
+    _table         = frames;
+    _samples       = samples;
+    _modulation_hz = modulation_hz;
+    return true;
+}
+
+bool FM::play(const uint32_t duration_ms)
+{
+    _stat = statistics_t{};
+    if (!_table || _samples < 2) {
+        M5_LIB_LOGE("Not prepared");
+        return false;
+    }
+    // samples * sample time is the duration, which must fit in 32-bit micros
+    if (duration_ms > UINT32_MAX / 1000U) {
+        M5_LIB_LOGE("duration_ms must be less than or equal to %u (%u)", UINT32_MAX / 1000U, duration_ms);
+        return false;
+    }
+    const uint64_t rate        = static_cast<uint64_t>(_samples) * _modulation_hz;
+    const uint32_t duration_us = duration_ms * 1000U;
+    const uint64_t total       = std::max<uint64_t>(1, duration_us * rate / 1000000U);
+
+    // Start with the frame for the inactive bank
+    uint8_t ctrl{};
+    if (!_unit.controlValid() && !_unit.readControl(ctrl)) {
+        M5_LIB_LOGE("Failed to read CONTROL");
+        return false;
+    }
+    size_t idx = _unit.currentFrequencyBank() ? 0 : 1;
+    if (!_unit.writeFrequencyFrame(_table[idx].data) || !_unit.writeCurrentFrequency(idx & 1)) {
+        ++_stat.failed;
+        return false;
+    }
+    const uint32_t start = m5::utility::micros();
+    ++_stat.samples;
+
+    for (uint64_t k = 1; k < total; ++k) {
+        idx = (idx + 1 < _samples) ? idx + 1 : 0;
+        // Sample k starts at k / rate
+        const uint32_t deadline = static_cast<uint32_t>(k * 1000000U / rate);
+        const bool bank         = idx & 1;
+        bool ok                 = _unit.writeFrequencyFrame(_table[idx].data);
+        uint32_t elapsed{};
+        if (ok) {
+            while ((elapsed = m5::utility::micros() - start) < deadline) {
+            }
+            ok = _unit.writeCurrentFrequency(bank);
+        }
+        if (!ok) {
+            // The flip may have been applied, follow the bank of the device
+            ++_stat.failed;
+            const bool current = _unit.readControl(ctrl) ? _unit.currentFrequencyBank() : !bank;
+            if (current != bank) {
+                // Not flipped, drop the next sample as well so the next frame goes to the inactive bank
+                ++k;
+                idx = (idx + 1 < _samples) ? idx + 1 : 0;
+            }
+            continue;
+        }
+        _stat.max_lateness = std::max(_stat.max_lateness, elapsed - deadline);
+        ++_stat.samples;
+    }
+    // The last sample lasts until the end of the duration
+    while ((_stat.duration_us = m5::utility::micros() - start) < duration_us) {
+    }
+    _stat.sample_rate =
+        static_cast<uint32_t>(static_cast<uint64_t>(_stat.samples) * 1000000U / std::max<uint32_t>(_stat.duration_us, 1));
+    return _stat.failed == 0;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_fm.hpp
+  @brief Software FM modulator for UnitDDS
+  @code
+  static m5::unit::dds::FM::Frame frames[256];
+  m5::unit::dds::FM fm(unit);
+  // 10kHz carrier, +-2kHz deviation, 50Hz sine modulation
+  if (fm.prepare(frames, 256, 10000, 2000, 50)) {
+      M5_LOGI("Sample rate %u Hz", fm.sampleRate());
+      fm.play(1000);
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_FM_HPP
+#define M5_UNIT_DDS_DDS_FM_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::FM
+  @brief Streams precomputed frequency frames of one modulation period through bank ping-pong
+  @details Frame i is encoded for bank (i & 1), so each sample is a 4-byte write of the table as is
+  and a single CONTROL write that flips the bank at its deadline.
+  The number of samples is even, so the banks keep alternating across periods.
+ */
+class FM {
+public:
+    /*!
+      @struct Frame
+      @brief Frequency frame with bank select (See also codec::encode_ftw)
+     */
+    struct Frame {
+        uint8_t data[4];
+    };
+
+    /*!
+      @enum Waveform
+      @brief Modulating waveform
+     */
+    enum class Waveform : uint8_t {
+        Sine,
+        Triangle,
+    };
+
+    /*!
+      @struct statistics_t
+      @brief Result of the last play()
+     */
+    struct statistics_t {
+        uint32_t samples{};       //!< Number of samples played
+        uint32_t failed{};        //!< Number of samples dropped by I2C failure
+        uint32_t max_lateness{};  //!< Maximum lateness of the flips (us)
+        uint32_t duration_us{};   //!< Measured duration (us)
+        uint32_t sample_rate{};   //!< Effective sample rate (Hz)
+    };
+
+    explicit FM(UnitDDS& unit);
+
+    /*!
+      @brief Measure the time of one sample on the current bus
+      @param samples Number of samples to measure
+      @return Time of one sample (us), 0 if failed
+      @note The current frequency is rewritten to the other bank, the output does not change
+     */
+    uint32_t measure(const uint32_t samples = 8);
+
+    /*!
+      @brief Fill the frames of one modulation period
+      @param frames Table
+      @param samples Number of samples (even, at least 2)
+      @param carrier_hz Carrier frequency (Hz)
+      @param deviation_hz Peak deviation (Hz), carrier +- deviation must be 0 - 1MHz
+      @param waveform Modulating waveform
+      @return True if successful
+     */
+    static bool generate(Frame* frames, const size_t samples, const uint32_t carrier_hz, const uint32_t deviation_hz,
+                         const Waveform waveform = Waveform::Sine);
+    /*!
+      @brief Fill the frames from an arbitrary modulating waveform
+      @param frames Table
+      @param wave Modulating samples (-32767 - 32767 is -deviation - +deviation)
+      @param samples Number of samples (even, at least 2)
+      @param carrier_hz Carrier frequency (Hz)
+      @param deviation_hz Peak deviation (Hz), carrier +- deviation must be 0 - 1MHz
+      @return True if successful
+     */
+    static bool generate(Frame* frames, const int16_t* wave, const size_t samples, const uint32_t carrier_hz,
+                         const uint32_t deviation_hz);
+
+    /*!
+      @brief Prepare the modulation
+      @details Measures the sample time if not yet, chooses the number of samples per period
+      at the maximum sustainable rate and fills the table
+      @param buf Table (must be alive until play() is done)
+      @param capacity Number of entries of buf
+      @param carrier_hz Carrier frequency (Hz)
+      @param deviation_hz Peak deviation (Hz)
+      @param modulation_hz Modulating frequency (Hz)
+      @param waveform Modulating waveform
+      @return Number of samples per period, 0 if failed
+      @note Keeps 1/8 of the measured sample time as a margin for jitter
+     */
+    size_t prepare(Frame* buf, const size_t capacity, const uint32_t carrier_hz, const uint32_t deviation_hz,
+                   const uint32_t modulation_hz, const Waveform waveform = Waveform::Sine);
+    /*!
+      @brief Use the table filled by the user
+      @param frames Table (must be alive until play() is done)
+      @param samples Number of samples (even, at least 2)
+      @param modulation_hz Modulating frequency (Hz)
+      @return True if successful
+     */
+    bool use(const Frame* frames, const size_t samples, const uint32_t modulation_hz);
+    /*!
+      @brief Play the prepared modulation
+      @param duration_ms Duration (ms)
+      @return True if all samples are played
+      @note Blocks for the duration, the last sample remains on output
+     */
+    bool play(const uint32_t duration_ms);
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the time of one sample (us), 0 if not measured
+    inline uint32_t sampleTime() const
+    {
+        return _sample_us;
+    }
+    //! @brief Set the time of one sample (us) instead of measure()
+    inline void sampleTime(const uint32_t us)
+    {
+        _sample_us = us;
+    }
+    //! @brief Gets the number of samples per period
+    inline size_t samples() const
+    {
+        return _samples;
+    }
+    //! @brief Gets the scheduled sample rate (Hz)
+    inline uint32_t sampleRate() const
+    {
+        return static_cast<uint32_t>(_samples * _modulation_hz);
+    }
+    //! @brief Gets the result of the last play()
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    ///@}
+
+private:
+    UnitDDS& _unit;
+    const Frame* _table{};
+    size_t _samples{};
+    uint32_t _modulation_hz{};
+    uint32_t _sample_us{};
+    statistics_t _stat{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
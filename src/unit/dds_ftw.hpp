@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_ftw.hpp
+  @brief Frequency tuning word (FTW) and phase word conversion for UnitDDS
+  @details All functions are constexpr, tables can be converted at compile time
+*/
+#ifndef M5_UNIT_DDS_DDS_FTW_HPP
+#define M5_UNIT_DDS_DDS_FTW_HPP
+
+#include <cstdint>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+//! @brief Master clock of the unit (Hz)
+constexpr uint32_t MCLK_HZ{10000000};
+//! @brief Maximum value of the 28-bit frequency tuning word
+constexpr uint32_t FTW_MAX{0x0FFFFFFF};
+
+/*!
+  @brief Calculate the 28-bit frequency tuning word (FTW)
+  @param hz Frequency (Hz)
+  @return FTW rounded to nearest
+ */
+constexpr uint32_t frequency_to_ftw(const uint32_t hz)
+{
+    return static_cast<uint32_t>(((static_cast<uint64_t>(hz) << 28) + MCLK_HZ / 2) / MCLK_HZ) & FTW_MAX;
+}
+/*!
+  @brief Calculate the frequency from the frequency tuning word
+  @param ftw FTW
+  @return Frequency (Hz) rounded to nearest
+ */
+constexpr uint32_t ftw_to_frequency(const uint32_t ftw)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(ftw & FTW_MAX) * MCLK_HZ + (1U << 27)) >> 28);
+}
+
+/*!
+  @brief Calculate the 11-bit phase word
+  @param deg Phase (degree)
+  @return Phase word rounded to nearest
+ */
+constexpr uint16_t degree_to_phase(const uint16_t deg)
+{
+    return static_cast<uint16_t>(((deg % 360U) * 2048U + 180U) / 360U) & 0x7FF;
+}
+
+///@cond
+namespace detail {
+// MIDI note 120 - 131 (mHz, A4 = 440Hz equal temperament)
+constexpr uint32_t top_octave_mhz[12] = {
+    8372018, 8869844, 9397273, 9956063, 10548082, 11175303, 11839822, 12543854, 13289750, 14080000, 14917240, 15804266,
+};
+constexpr uint64_t midi_divisor(const uint8_t octave)
+{
+    return (static_cast<uint64_t>(MCLK_HZ) * 1000U) << (10 - octave);
+}
+constexpr uint32_t midi_ftw(const uint64_t mhz, const uint64_t div)
+{
+    return static_cast<uint32_t>(((mhz << 28) + div / 2) / div);
+}
+}  // namespace detail
+///@endcond
+
+/*!
+  @brief Calculate the FTW of the MIDI note
+  @param midi MIDI note number 0 - 127 (69 is A4 440Hz)
+  @return FTW rounded to nearest
+ */
+constexpr uint32_t midi_to_ftw(const uint8_t midi)
+{
+    return detail::midi_ftw(detail::top_octave_mhz[(midi & 0x7F) % 12], detail::midi_divisor((midi & 0x7F) / 12));
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_group.cpp
+  @brief Coherent start of multiple UnitDDS
+*/
+#include "dds_group.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <algorithm>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+constexpr size_t Group::MAX_UNITS;
+
+bool Group::add(UnitDDS& unit)
+{
+    if (_count >= MAX_UNITS) {
+        M5_LIB_LOGE("Up to %zu units", MAX_UNITS);
+        return false;
+    }
+    _unit[_count++] = &unit;
+    return true;
+}
+
+bool Group::hold()
+{
+    for (size_t i = 0; i < _count; ++i) {
+        if (!_unit[i]->writeReset(true)) {
+            M5_LIB_LOGE("Failed to hold %zu", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Group::program(const size_t index, const Setting& setting)
+{
+    if (index >= _count) {
+        return false;
+    }
+    // Held in RESET by the same write
+    return _unit[index]->program(setting.mode, false, setting.freq, setting.deg, true);
+}
+
+bool Group::release()
+{
+    if (!_count) {
+        return false;
+    }
+    // Back to back, nothing but the CONTROL writes between the releases
+    bool ok{true};
+    uint32_t t[MAX_UNITS]{};
+    for (size_t i = 0; i < _count; ++i) {
+        ok &= _unit[i]->writeReset(false);
+        t[i] = m5::utility::micros();
+    }
+    for (size_t i = 0; i < _count; ++i) {
+        _offset[i] = t[i] - t[0];
+    }
+    _stat.last_skew_us = _offset[_count - 1];
+    _stat.max_skew_us  = std::max(_stat.max_skew_us, _stat.last_skew_us);
+    return ok;
+}
+
+bool Group::start(const Setting* settings)
+{
+    if (!settings) {
+        return false;
+    }
+    return start_with([settings](const size_t i) -> const Setting& { return settings[i]; });
+}
+
+bool Group::start(const Setting& setting)
+{
+    return start_with([&setting](const size_t) -> const Setting& { return setting; });
+}
+
+template <typename F>
+bool Group::start_with(F setting_of)
+{
+    // Each unit is held by its program()
+    bool ok{_count > 0};
+    if (!ok) {
+        M5_LIB_LOGE("No units");
+    }
+    for (size_t i = 0; ok && i < _count; ++i) {
+        ok = program(i, setting_of(i));
+    }
+    ok = ok && release();
+    ++(ok ? _stat.starts : _stat.failed);
+    return ok;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_group.hpp
+  @brief Coherent start of multiple UnitDDS
+  @code
+  m5::unit::dds::Group group;
+  group.add(unit_a);
+  group.add(unit_b);
+  // Same frequency, 90 degree apart
+  const m5::unit::dds::Group::Setting settings[] = {
+      {m5::unit::dds::Mode::Sin, 1000, 0},
+      {m5::unit::dds::Mode::Sin, 1000, 90},
+  };
+  if (group.start(settings)) {
+      M5_LOGI("Release skew %u us", group.statistics().last_skew_us);
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_GROUP_HPP
+#define M5_UNIT_DDS_DDS_GROUP_HPP
+
+#include "dds_codec.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::Group
+  @brief Starts the units from RESET at the same time
+  @details All units are held in RESET while their frequency and phase are programmed,
+  then RESET is released by a single CONTROL write per unit back to back.
+  The relative phase depends only on the release skew, which is reported.
+  @note Units on the same bus are released one transaction apart
+  @note Verification (UnitDDS::verification) adds a readback to each release
+ */
+class Group {
+public:
+    //! @brief Maximum number of units
+    static constexpr size_t MAX_UNITS{8};
+
+    /*!
+      @struct Setting
+      @brief Output of a unit
+     */
+    struct Setting {
+        Mode mode;      //!< Output mode
+        uint32_t freq;  //!< Frequency (Hz)
+        uint16_t deg;   //!< Phase (degree)
+    };
+
+    /*!
+      @struct statistics_t
+      @brief Release skew
+     */
+    struct statistics_t {
+        uint32_t starts{};        //!< Number of starts
+        uint32_t failed{};        //!< Number of starts failed by I2C
+        uint32_t last_skew_us{};  //!< Time from the first to the last release of the last start (us)
+        uint32_t max_skew_us{};   //!< Maximum skew (us)
+    };
+
+    /*!
+      @brief Add the unit
+      @return True if successful
+     */
+    bool add(UnitDDS& unit);
+    //! @brief Remove all units
+    inline void clear()
+    {
+        _count = 0;
+    }
+    //! @brief Gets the number of units
+    inline size_t size() const
+    {
+        return _count;
+    }
+
+    //! @brief Hold all units in RESET
+    bool hold();
+    /*!
+      @brief Program the unit and hold it in RESET
+      @param index Unit index
+      @param setting Output (bank 0 is used)
+      @return True if successful
+      @sa UnitDDS::program
+     */
+    bool program(const size_t index, const Setting& setting);
+    /*!
+      @brief Release RESET of all units back to back
+      @return True if all are released
+      @note Continues to the remaining units if one fails
+     */
+    bool release();
+
+    /*!
+      @brief Program and hold each unit, then release all
+      @details 2 transactions per unit and a release, e.g. to initialize a fleet in one pass
+      @param settings Output of each unit (size() entries)
+      @return True if successful
+     */
+    bool start(const Setting* settings);
+    //! @brief Start all units with the same output in one pass
+    bool start(const Setting& setting);
+
+    ///@name Properties
+    ///@{
+    /*!
+      @brief Gets the release time of the unit from the first release of the last start
+      @param index Unit index
+      @return Offset (us)
+     */
+    inline uint32_t releaseOffset(const size_t index) const
+    {
+        return index < _count ? _offset[index] : 0;
+    }
+    //! @brief Gets the statistics
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    ///@}
+
+protected:
+    template <typename F>
+    bool start_with(F setting_of);
+
+private:
+    UnitDDS* _unit[MAX_UNITS]{};
+    uint32_t _offset[MAX_UNITS]{};
+    size_t _count{};
+    statistics_t _stat{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
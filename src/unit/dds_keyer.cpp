@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_keyer.cpp
+  @brief OOK / Morse keyer for UnitDDS
+*/
+#include "dds_keyer.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <algorithm>
+#include <cctype>
+
+using m5::unit::dds::Keyer;
+using m5::unit::dds::KEY_ON;
+
+namespace {
+
+constexpr const char* morse_letters[] = {
+    ".-",   "-...", "-.-.", "-..",  ".",   "..-.", "--.",  "....", "..",   ".---", "-.-",  ".-..", "--",
+    "-.",   "---",  ".--.", "--.-", ".-.", "...",  "-",    "..-",  "...-", ".--",  "-..-", "-.--", "--..",
+};
+constexpr const char* morse_digits[] = {
+    "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----.",
+};
+
+const char* morse_code(const char c)
+{
+    const int u = std::toupper(static_cast<unsigned char>(c));
+    if (u >= 'A' && u <= 'Z') {
+        return morse_letters[u - 'A'];
+    }
+    if (u >= '0' && u <= '9') {
+        return morse_digits[u - '0'];
+    }
+    switch (u) {
+        case '.':
+            return ".-.-.-";
+        case ',':
+            return "--..--";
+        case '?':
+            return "..--..";
+        case '/':
+            return "-..-.";
+        case '=':
+            return "-...-";
+        default:
+            return nullptr;
+    }
+}
+
+// Appends elements, merging the same key state
+class Builder {
+public:
+    Builder(Keyer::Element* buf, const size_t capacity) : _buf(buf), _capacity(capacity)
+    {
+    }
+    void add(const bool on, const uint32_t us)
+    {
+        // A new element of the same state if the merged duration exceeds 31 bits
+        if (_count && _buf[_count - 1].on() == on && us <= (~KEY_ON) - _buf[_count - 1].us()) {
+            _buf[_count - 1] = on ? Keyer::mark(_buf[_count - 1].us() + us) : Keyer::space(_buf[_count - 1].us() + us);
+            return;
+        }
+        if (_count >= _capacity) {
+            _overflow = true;
+            return;
+        }
+        _buf[_count++] = on ? Keyer::mark(us) : Keyer::space(us);
+    }
+    size_t result() const
+    {
+        if (_overflow) {
+            M5_LIB_LOGE("Not enough capacity %zu", _capacity);
+            return 0;
+        }
+        return _count;
+    }
+
+private:
+    Keyer::Element* _buf{};
+    size_t _capacity{}, _count{};
+    bool _overflow{};
+};
+
+}  // namespace
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+Keyer::Keyer(UnitDDS& unit) : _unit(unit)
+{
+}
+
+size_t Keyer::morse(Element* buf, const size_t capacity, const char* text, const uint32_t dot)
+{
+    if (!buf || !text || !dot || dot > (KEY_ON - 1) / 7) {
+        M5_LIB_LOGE("Invalid arguments");
+        return 0;
+    }
+    Builder b(buf, capacity);
+    uint32_t gap{};  // Pending gap in dots, 0 at the beginning
+    bool first{true};
+    for (const char* p = text; *p; ++p) {
+        if (*p == ' ') {
+            gap = first ? 0 : 7;
+            continue;
+        }
+        const char* code = morse_code(*p);
+        if (!code) {
+            M5_LIB_LOGE("Unsupported character %c", *p);
+            return 0;
+        }
+        if (!first) {
+            b.add(false, std::max<uint32_t>(gap, 3) * dot);
+        }
+        for (const char* e = code; *e; ++e) {
+            if (e != code) {
+                b.add(false, dot);
+            }
+            b.add(true, (*e == '-' ? 3 : 1) * dot);
+        }
+        first = false;
+        gap   = 0;
+    }
+    return b.result();
+}
+
+size_t Keyer::bits(Element* buf, const size_t capacity, const uint8_t* data, const size_t bits, const uint32_t bit_us)
+{
+    if (!buf || !data || !bits || !bit_us || bit_us >= KEY_ON) {
+        M5_LIB_LOGE("Invalid arguments");
+        return 0;
+    }
+    Builder b(buf, capacity);
+    for (size_t i = 0; i < bits; ++i) {
+        b.add((data[i >> 3] >> (7 - (i & 7))) & 1, bit_us);
+    }
+    return b.result();
+}
+
+bool Keyer::play(const Element* elements, const size_t count)
+{
+    _stat = statistics_t{};
+    if (!elements || !count) {
+        M5_LIB_LOGE("No elements");
+        return false;
+    }
+    _stat.min_latency_us = 0xFFFFFFFFU;
+
+    // The first edge starts the clock
+    bool on              = elements[0].on();
+    const uint32_t start = m5::utility::micros();
+    edge(on, start, 0);
+    uint32_t deadline = elements[0].us();
+
+    for (size_t i = 1; i < count; ++i) {
+        if (elements[i].on() != on) {
+            on = elements[i].on();
+            edge(on, start, deadline);
+        }
+        deadline += elements[i].us();
+    }
+    // Key up at the end
+    if (on) {
+        edge(false, start, deadline);
+    }
+    while ((_stat.duration_us = m5::utility::micros() - start) < deadline) {
+    }
+    _stat.min_latency_us = std::min(_stat.min_latency_us, _stat.max_latency_us);
+    _stat.jitter_us      = _stat.max_latency_us - _stat.min_latency_us;
+    return _stat.failed == 0;
+}
+
+bool Keyer::edge(const bool on, const uint32_t start, const uint32_t deadline)
+{
+    while (m5::utility::micros() - start < deadline) {
+    }
+    if (!_unit.key(on)) {
+        ++_stat.failed;
+        return false;
+    }
+    const uint32_t latency = m5::utility::micros() - start - deadline;
+    _stat.min_latency_us   = std::min(_stat.min_latency_us, latency);
+    _stat.max_latency_us   = std::max(_stat.max_latency_us, latency);
+    ++_stat.edges;
+    return true;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
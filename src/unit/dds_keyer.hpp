@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_keyer.hpp
+  @brief OOK / Morse keyer for UnitDDS
+  @code
+  static m5::unit::dds::Keyer::Element beacon[128];
+  // 20 WPM
+  auto n = m5::unit::dds::Keyer::morse(beacon, 128, "VVV DE M5", m5::unit::dds::Keyer::dot_us(20));
+  unit.writeOutput(m5::unit::dds::Mode::Sin, false, 700, 0);
+  m5::unit::dds::Keyer keyer(unit);
+  keyer.play(beacon, n);
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_KEYER_HPP
+#define M5_UNIT_DDS_DDS_KEYER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+//! @brief Key down flag of Keyer::Element::word
+constexpr uint32_t KEY_ON{0x80000000};
+
+/*!
+  @class m5::unit::dds::Keyer
+  @brief Keys the output by the DAC sleep bit along a timing table
+  @details Each edge is a single CONTROL write of SLEEP12 from the cached CONTROL (UnitDDS::key),
+  issued at its deadline from the start of the table.
+ */
+class Keyer {
+public:
+    /*!
+      @struct Element
+      @brief Packed key element
+     */
+    struct Element {
+        uint32_t word;  //!< Duration (us, bit 0-30) and KEY_ON
+
+        //! @brief Is the key down?
+        constexpr bool on() const
+        {
+            return word & KEY_ON;
+        }
+        //! @brief Gets the duration (us)
+        constexpr uint32_t us() const
+        {
+            return word & ~KEY_ON;
+        }
+    };
+
+    /*!
+      @struct statistics_t
+      @brief Edge timing of the last play()
+     */
+    struct statistics_t {
+        uint32_t edges{};           //!< Number of edges
+        uint32_t failed{};          //!< Number of edges failed by I2C
+        uint32_t min_latency_us{};  //!< Minimum time from the deadline to the completion of the write (us)
+        uint32_t max_latency_us{};  //!< Maximum time from the deadline to the completion of the write (us)
+        uint32_t jitter_us{};       //!< max_latency_us - min_latency_us
+        uint32_t duration_us{};     //!< Measured duration (us)
+    };
+
+    //! @brief Key down element
+    static constexpr Element mark(const uint32_t us)
+    {
+        return Element{(us & ~KEY_ON) | KEY_ON};
+    }
+    //! @brief Key up element
+    static constexpr Element space(const uint32_t us)
+    {
+        return Element{us & ~KEY_ON};
+    }
+    //! @brief Dot length of the Morse speed (PARIS)
+    static constexpr uint32_t dot_us(const uint32_t wpm)
+    {
+        return wpm ? 1200000U / wpm : 0;
+    }
+
+    explicit Keyer(UnitDDS& unit);
+
+    /*!
+      @brief Fill the elements of the Morse code
+      @param buf Elements
+      @param capacity Number of entries of buf
+      @param text 'A'-'Z', '0'-'9', some punctuations ( . , ? / = ) and spaces between words
+      @param dot Dot length (us)
+      @return Number of elements, 0 if failed
+      @note dot 1, dash 3, gap in a character 1, between characters 3, between words 7
+     */
+    static size_t morse(Element* buf, const size_t capacity, const char* text, const uint32_t dot);
+    /*!
+      @brief Fill the elements of the bit sequence
+      @param buf Elements
+      @param capacity Number of entries of buf
+      @param data Bits, MSB first, 1 is key down
+      @param bits Number of bits
+      @param bit_us Bit length (us)
+      @return Number of elements, 0 if failed
+      @note The same consecutive bits are merged into an element up to the 31-bit duration
+     */
+    static size_t bits(Element* buf, const size_t capacity, const uint8_t* data, const size_t bits,
+                       const uint32_t bit_us);
+
+    /*!
+      @brief Play the elements
+      @param elements Elements
+      @param count Number of elements
+      @return True if all edges are keyed
+      @note Blocks for the duration, the key is up after the end
+     */
+    bool play(const Element* elements, const size_t count);
+    //! @brief Play the elements
+    template <size_t N>
+    inline bool play(const Element (&elements)[N])
+    {
+        return play(elements, N);
+    }
+
+    //! @brief Gets the result of the last play()
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+
+private:
+    bool edge(const bool on, const uint32_t start, const uint32_t deadline);
+
+    UnitDDS& _unit;
+    statistics_t _stat{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
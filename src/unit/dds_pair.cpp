@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_pair.cpp
+  @brief Two-tone / DTMF generation with paired UnitDDS
+*/
+#include "dds_pair.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+#include <algorithm>
+
+using namespace m5::unit::dds;
+
+namespace {
+
+constexpr char DTMF_KEYS[] = "123A456B789C*0#D";
+
+// Row (low) and column (high) FTWs
+constexpr uint32_t DTMF_ROW[4] = {
+    frequency_to_ftw(697),
+    frequency_to_ftw(770),
+    frequency_to_ftw(852),
+    frequency_to_ftw(941),
+};
+constexpr uint32_t DTMF_COLUMN[4] = {
+    frequency_to_ftw(1209),
+    frequency_to_ftw(1336),
+    frequency_to_ftw(1477),
+    frequency_to_ftw(1633),
+};
+
+}  // namespace
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+Pair::Pair(UnitDDS& low, UnitDDS& high) : _unit{&low, &high}
+{
+}
+
+bool Pair::dtmf(const char key, uint32_t& low, uint32_t& high)
+{
+    const char k = (key >= 'a' && key <= 'd') ? key - 'a' + 'A' : key;
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (DTMF_KEYS[i] == k) {
+            low  = DTMF_ROW[i / 4];
+            high = DTMF_COLUMN[i % 4];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Pair::prepare(const uint32_t low_ftw, const uint32_t high_ftw)
+{
+    const uint32_t ftw[2] = {low_ftw, high_ftw};
+    _prepared             = false;
+    for (uint32_t i = 0; i < 2; ++i) {
+        // The cached CONTROL is unknown after a failed write
+        uint8_t ctrl{};
+        if (!_unit[i]->controlValid() && !_unit[i]->readControl(ctrl)) {
+            return false;
+        }
+        _bank[i] = !_unit[i]->currentFrequencyBank();
+        if (!_unit[i]->writeFrequencyWord(_bank[i], ftw[i])) {
+            return false;
+        }
+    }
+    _prepared = true;
+    return true;
+}
+
+bool Pair::flip()
+{
+    if (!_prepared) {
+        M5_LIB_LOGE("Not prepared");
+        return false;
+    }
+    _prepared = false;
+
+    // Each flip takes effect at the end of its transaction
+    if (!_unit[0]->writeCurrentFrequency(_bank[0])) {
+        return false;
+    }
+    const uint32_t end0 = m5::utility::micros();
+    if (!_unit[1]->writeCurrentFrequency(_bank[1])) {
+        return false;
+    }
+    _stat.last_skew_us = m5::utility::micros() - end0;
+    _stat.max_skew_us  = std::max(_stat.max_skew_us, _stat.last_skew_us);
+    return true;
+}
+
+bool Pair::writeTones(const uint32_t low_hz, const uint32_t high_hz)
+{
+    if (!codec::is_valid_frequency(low_hz) || !codec::is_valid_frequency(high_hz)) {
+        M5_LIB_LOGE("freq must be between %u and %u (%u/%u)", codec::MINIMUM_FREQ, codec::MAXIMUM_FREQ, low_hz,
+                    high_hz);
+        return false;
+    }
+    return switch_to(frequency_to_ftw(low_hz), frequency_to_ftw(high_hz));
+}
+
+bool Pair::dtmf(const char key)
+{
+    uint32_t low{}, high{};
+    if (!dtmf(key, low, high)) {
+        M5_LIB_LOGE("Invalid key %c", key);
+        return false;
+    }
+    return switch_to(low, high);
+}
+
+bool Pair::switch_to(const uint32_t low_ftw, const uint32_t high_ftw)
+{
+    const uint32_t start = m5::utility::micros();
+    if (!prepare(low_ftw, high_ftw) || !flip()) {
+        ++_stat.failed;
+        return false;
+    }
+    ++_stat.switches;
+    _stat.last_switch_us = m5::utility::micros() - start;
+    _stat.max_switch_us  = std::max(_stat.max_switch_us, _stat.last_switch_us);
+    return true;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_pair.hpp
+  @brief Two-tone / DTMF generation with paired UnitDDS
+  @code
+  m5::unit::dds::Pair pair(unit_low, unit_high);
+  for (auto&& c : "0123456789") {
+      pair.dtmf(c);
+      m5::utility::delay(70);
+  }
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_PAIR_HPP
+#define M5_UNIT_DDS_DDS_PAIR_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::Pair
+  @brief Paired units outputting two tones
+  @details Both inactive banks are written first, then the two CONTROL writes that flip the banks
+  are issued back to back, so the skew between units is a single CONTROL transaction.
+  @note Mix the outputs externally
+ */
+class Pair {
+public:
+    /*!
+      @struct statistics_t
+      @brief Switch time and inter-unit skew
+     */
+    struct statistics_t {
+        uint32_t switches{};        //!< Number of switches
+        uint32_t failed{};          //!< Number of switches failed by I2C
+        uint32_t last_switch_us{};  //!< Time of the last switch including the bank writes (us)
+        uint32_t max_switch_us{};   //!< Maximum time of the switch (us)
+        uint32_t last_skew_us{};    //!< Skew of the last flip between units (us)
+        uint32_t max_skew_us{};     //!< Maximum skew between units (us)
+    };
+
+    /*!
+      @param low Unit for the low tone (DTMF row)
+      @param high Unit for the high tone (DTMF column)
+     */
+    Pair(UnitDDS& low, UnitDDS& high);
+
+    /*!
+      @brief Gets the FTW pair of the DTMF key
+      @param key '0'-'9', '*', '#', 'A'-'D'
+      @param[out] low FTW of the row frequency
+      @param[out] high FTW of the column frequency
+      @return True if the key is valid
+     */
+    static bool dtmf(const char key, uint32_t& low, uint32_t& high);
+
+    /*!
+      @brief Write the tones to the inactive banks
+      @param low_ftw FTW for the low unit
+      @param high_ftw FTW for the high unit
+      @return True if successful
+      @sa m5::unit::dds::frequency_to_ftw
+     */
+    bool prepare(const uint32_t low_ftw, const uint32_t high_ftw);
+    /*!
+      @brief Switch both units to the prepared banks
+      @return True if successful
+     */
+    bool flip();
+
+    /*!
+      @brief Output the two tones
+      @param low_hz Frequency of the low unit (Hz) 0 - 1MHz
+      @param high_hz Frequency of the high unit (Hz) 0 - 1MHz
+      @return True if successful
+     */
+    bool writeTones(const uint32_t low_hz, const uint32_t high_hz);
+    /*!
+      @brief Output the DTMF symbol
+      @param key '0'-'9', '*', '#', 'A'-'D'
+      @return True if successful
+     */
+    bool dtmf(const char key);
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the statistics
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    //! @brief Reset the statistics
+    inline void resetStatistics()
+    {
+        _stat = statistics_t{};
+    }
+    ///@}
+
+protected:
+    bool switch_to(const uint32_t low_ftw, const uint32_t high_ftw);
+
+private:
+    UnitDDS* _unit[2]{};
+    bool _bank[2]{};  // Prepared banks
+    bool _prepared{};
+    statistics_t _stat{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
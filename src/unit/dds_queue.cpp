@@ -0,0 +1,174 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_queue.cpp
+  @brief Command queue for UnitDDS behind I2C hubs
+*/
+#include "dds_queue.hpp"
+#include <M5Utility.hpp>
+#include <algorithm>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+CommandQueue::CommandQueue(const size_t capacity) : _capacity(capacity ? capacity : 1)
+{
+    _queue.reserve(_capacity);
+    _work.reserve(_capacity);
+    _ops.reserve(_capacity);
+}
+
+bool CommandQueue::push(UnitDDS& unit, const Op& op)
+{
+    const uint32_t now = m5::utility::micros();
+    if (_coalescing && coalesce(unit, op, now)) {
+        return true;
+    }
+    if (_queue.size() >= _capacity) {
+        M5_LIB_LOGW("Queue is full");
+        return false;
+    }
+    entry_t e{};
+    e.unit  = &unit;
+    e.op    = op;
+    e.route = route_of(unit);
+    e.at    = now;
+    _queue.push_back(e);
+    return true;
+}
+
+size_t CommandQueue::update()
+{
+    if (_queue.empty()) {
+        return 0;
+    }
+    // The hub channel may have been changed by others since the last update, so it is unknown
+    _selected.clear();
+
+    // Channel changes in the submission order
+    uint32_t naive{};
+    for (auto&& e : _queue) {
+        naive += select(_selected, e.route);
+    }
+    _selected.clear();
+    arrange();
+
+    const uint32_t switches = _stat.channel_switches;
+    size_t succeeded{};
+    size_t i{};
+    while (i < _queue.size()) {
+        size_t j = i + 1;
+        while (j < _queue.size() && _queue[j].unit == _queue[i].unit) {
+            ++j;
+        }
+        _stat.channel_switches += select(_selected, _queue[i].route);
+        succeeded += execute(_queue.data() + i, j - i);
+        i = j;
+    }
+    const uint32_t actual = _stat.channel_switches - switches;
+    _stat.switches_saved += (naive > actual) ? naive - actual : 0;
+    _queue.clear();
+    return succeeded;
+}
+
+CommandQueue::route_t CommandQueue::route_of(UnitDDS& unit)
+{
+    route_t r{};
+    if (unit.hasParent()) {
+        r.hub     = unit.parent();
+        r.channel = unit.channel();
+    }
+    return r;
+}
+
+// Replace the pending command of the same unit, type and bank, not across Mode/Current/Sleep
+bool CommandQueue::coalesce(UnitDDS& unit, const Op& op, const uint32_t now)
+{
+    if (op.type != Op::Type::Frequency && op.type != Op::Type::Phase) {
+        return false;
+    }
+    for (auto it = _queue.rbegin(); it != _queue.rend(); ++it) {
+        if (it->unit != &unit) {
+            continue;
+        }
+        if (it->op.type != Op::Type::Frequency && it->op.type != Op::Type::Phase) {
+            break;
+        }
+        if (it->op.type == op.type && it->op.select == op.select) {
+            it->op = op;
+            it->at = now;
+            ++_stat.coalesced;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CommandQueue::select(std::vector<route_t>& selected, const route_t& route)
+{
+    if (!route.hub) {
+        return false;
+    }
+    for (auto&& s : selected) {
+        if (s.hub == route.hub) {
+            const bool changed = s.channel != route.channel;
+            s.channel          = route.channel;
+            return changed;
+        }
+    }
+    selected.push_back(route);
+    return true;
+}
+
+// Ranks the commands: units on the bus directly first, then routes in order of appearance,
+// and the commands of a unit together in order of submission
+void CommandQueue::arrange()
+{
+    _work.clear();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (auto&& e : _queue) {
+            if (!e.route.hub == (pass == 0) && std::find(_work.begin(), _work.end(), e.route) == _work.end()) {
+                _work.push_back(e.route);
+            }
+        }
+    }
+    for (size_t i = 0; i < _queue.size(); ++i) {
+        auto& e           = _queue[i];
+        const auto group  = std::find(_work.begin(), _work.end(), e.route) - _work.begin();
+        size_t first_unit = i;
+        for (size_t k = 0; k < i; ++k) {
+            if (_queue[k].unit == e.unit) {
+                first_unit = k;
+                break;
+            }
+        }
+        e.rank = (static_cast<uint32_t>(group) << 16) | static_cast<uint32_t>(first_unit);
+    }
+    std::stable_sort(_queue.begin(), _queue.end(),
+                     [](const entry_t& a, const entry_t& b) { return a.rank < b.rank; });
+}
+
+// Commands of a unit in a single batch
+size_t CommandQueue::execute(const entry_t* entries, const size_t count)
+{
+    _ops.clear();
+    const uint32_t now = m5::utility::micros();
+    for (size_t i = 0; i < count; ++i) {
+        _ops.push_back(entries[i].op);
+        _stat.last_age_us = now - entries[i].at;
+        _stat.max_age_us  = std::max(_stat.max_age_us, _stat.last_age_us);
+    }
+    const size_t succeeded = entries[0].unit->writeBatch(_ops.data(), _ops.size());
+    ++_stat.batches;
+    _stat.executed += succeeded;
+    _stat.failed += count - succeeded;
+    return succeeded;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_queue.hpp
+  @brief Command queue for UnitDDS behind I2C hubs
+  @code
+  // Units are children of PaHub (hub.add(unit, channel))
+  m5::unit::dds::CommandQueue queue;
+  queue.push(unit_a, m5::unit::dds::Op::frequency(false, 1000));
+  queue.push(unit_b, m5::unit::dds::Op::frequency(false, 2000));
+  queue.push(unit_a, m5::unit::dds::Op::current(false, false));
+  queue.update();  // unit_a (2 ops in a batch), then unit_b
+
+  // Latest-wins, a control loop faster than the bus
+  queue.coalescing(true);
+  queue.push(unit_a, m5::unit::dds::Op::frequency(false, 1000));
+  queue.push(unit_a, m5::unit::dds::Op::frequency(false, 1001));  // Replaces 1000
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_QUEUE_HPP
+#define M5_UNIT_DDS_DDS_QUEUE_HPP
+
+#include "unit_DDS.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+/*!
+  @class m5::unit::dds::CommandQueue
+  @brief Executes the pending commands of many units ordered by hub channel
+  @details update() groups the pending commands by the hub channel the unit is attached to
+  (Component::parent() and Component::channel()), starting with the units on the bus directly,
+  and writes the commands of each unit with a single UnitDDS::writeBatch.
+  The selected channel of each hub is unknown at the start of update(), since other code may select
+  another one in between, so the first channel of each hub counts as a switch.
+  The order of the commands of each unit is kept, the order between units is not.
+  With coalescing, a frequency/phase command replaces the pending one of the same unit and bank
+  in its place (latest-wins). Mode, Current and Sleep commands are never replaced,
+  and a command is never moved across them.
+  @note Not thread-safe, push() and update() from the same task
+ */
+class CommandQueue {
+public:
+    /*!
+      @struct statistics_t
+      @brief Statistics of the executed commands
+     */
+    struct statistics_t {
+        uint32_t executed{};          //!< Number of succeeded commands
+        uint32_t failed{};            //!< Number of failed commands
+        uint32_t batches{};           //!< Number of writeBatch calls
+        uint32_t channel_switches{};  //!< Number of hub channel changes
+        uint32_t switches_saved{};    //!< Channel changes saved against the submission order
+        uint32_t coalesced{};         //!< Number of commands replaced by a newer one before transmission
+        uint32_t last_age_us{};       //!< Time from push to transmission of the last written command (us)
+        uint32_t max_age_us{};        //!< Maximum of last_age_us
+    };
+
+    //! @param capacity Maximum number of pending commands
+    explicit CommandQueue(const size_t capacity = 32);
+
+    /*!
+      @brief Add the command
+      @param unit Target unit
+      @param op Operation
+      @return True if successful, false if the queue is full
+      @note With coalescing, a replacing command succeeds even if the queue is full
+     */
+    bool push(UnitDDS& unit, const Op& op);
+    /*!
+      @brief Execute all pending commands
+      @return Number of succeeded commands
+     */
+    size_t update();
+    //! @brief Discard all pending commands
+    inline void clear()
+    {
+        _queue.clear();
+    }
+
+    ///@name Coalescing
+    ///@{
+    //! @brief Enable/Disable latest-wins coalescing of frequency and phase commands
+    inline void coalescing(const bool enable)
+    {
+        _coalescing = enable;
+    }
+    //! @brief Is coalescing enabled?
+    inline bool coalescing() const
+    {
+        return _coalescing;
+    }
+    ///@}
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the number of pending commands
+    inline size_t pending() const
+    {
+        return _queue.size();
+    }
+    //! @brief Gets the statistics
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    //! @brief Reset the statistics
+    inline void resetStatistics()
+    {
+        _stat = statistics_t{};
+    }
+    ///@}
+
+protected:
+    // Hub and its channel, null hub if the unit is on the bus directly
+    struct route_t {
+        Component* hub{};
+        int16_t channel{-1};
+        inline bool operator==(const route_t& o) const
+        {
+            return hub == o.hub && channel == o.channel;
+        }
+    };
+    struct entry_t {
+        UnitDDS* unit{};
+        Op op{};
+        route_t route{};
+        uint32_t rank{};  // Execution order
+        uint32_t at{};    // Pushed time of the value (us)
+    };
+
+    static route_t route_of(UnitDDS& unit);
+    bool coalesce(UnitDDS& unit, const Op& op, const uint32_t now);
+    // Select the route, returns true if the hub channel changes
+    static bool select(std::vector<route_t>& selected, const route_t& route);
+    void arrange();
+    size_t execute(const entry_t* entries, const size_t count);
+
+private:
+    size_t _capacity{};
+    std::vector<entry_t> _queue{};
+    std::vector<route_t> _selected{};  // Channel selected on each hub during update()
+    std::vector<route_t> _work{};
+    std::vector<Op> _ops{};
+    statistics_t _stat{};
+    bool _coalescing{};
+};
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_scheduler.cpp
+  @brief Time-scheduled command execution for UnitDDS
+*/
+#include "dds_scheduler.hpp"
+#include "unit_DDS.hpp"
+#include <M5Utility.hpp>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+template class BasicScheduler<UnitDDS>;
+
+Scheduler::Scheduler(UnitDDS& unit, const size_t capacity, clock_function_t clock)
+    : BasicScheduler<UnitDDS>(unit, capacity, clock ? clock : [this]() { return micros64(); })
+{
+}
+
+// Extend 32-bit micros to 64-bit
+uint64_t Scheduler::micros64()
+{
+    const uint32_t us = m5::utility::micros();
+    _micros += static_cast<uint32_t>(us - _last_micros);
+    _last_micros = us;
+    return _micros;
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,278 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_scheduler.hpp
+  @brief Time-scheduled command execution for UnitDDS
+*/
+#ifndef M5_UNIT_DDS_DDS_SCHEDULER_HPP
+#define M5_UNIT_DDS_DDS_SCHEDULER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace m5 {
+namespace unit {
+
+class UnitDDS;
+
+namespace dds {
+
+/*!
+  @class m5::unit::dds::BasicScheduler
+  @brief Executes frequency/phase changes at absolute times
+  @details The command is written to the inactive bank ahead of the deadline,
+  and only the single CONTROL write that flips the bank is issued at the deadline.
+  Call update() from a task or the loop, not from an interrupt handler
+  (it performs I2C transactions and may take the bus lock).
+  @tparam Unit Driver providing controlValid, readControl, currentFrequencyBank,
+  writeFrequencyAndPhase and writeCurrent (UnitDDS, BasicUnitDDS)
+  @note The clock is replaceable, e.g. by a virtual clock for deterministic tests
+ */
+template <class Unit>
+class BasicScheduler {
+public:
+    //! @brief Clock function (microseconds)
+    using clock_function_t = std::function<uint64_t()>;
+
+    /*!
+      @struct config_t
+      @brief Settings for Scheduler
+     */
+    struct config_t {
+        uint32_t lead_us{20 * 1000};  //!< Prepare the inactive bank this long before the deadline (us)
+        uint32_t spin_us{0};          //!< Busy-wait for the deadline if it is closer than this (us)
+        uint32_t late_us{100};        //!< Flip completed later than this is counted as late (us)
+    };
+
+    /*!
+      @struct command_t
+      @brief Scheduled command
+     */
+    struct command_t {
+        uint64_t at{};    //!< Deadline (us)
+        uint32_t freq{};  //!< Frequency (Hz)
+        uint16_t deg{};   //!< Phase (degree)
+    };
+
+    /*!
+      @struct statistics_t
+      @brief Lateness statistics
+      @details Lateness is the time from the deadline to the completion of the flip write
+     */
+    struct statistics_t {
+        uint32_t executed{};        //!< Number of flips issued
+        uint32_t late{};            //!< Number of flips later than config_t::late_us
+        uint32_t failed{};          //!< Number of commands dropped by I2C failure
+        uint32_t max_lateness{};    //!< Maximum lateness (us)
+        uint64_t total_lateness{};  //!< Total lateness (us)
+        //! @brief Average lateness (us)
+        inline uint32_t average() const
+        {
+            return executed ? static_cast<uint32_t>(total_lateness / executed) : 0;
+        }
+    };
+
+    /*!
+      @param unit Driver
+      @param capacity Maximum number of pending commands
+      @param clock Clock function
+     */
+    BasicScheduler(Unit& unit, const size_t capacity, clock_function_t clock)
+        : _unit(unit), _clock(clock), _capacity(capacity ? capacity : 1)
+    {
+        _queue.reserve(_capacity);
+    }
+
+    ///@name Settings
+    ///@{
+    //! @brief Gets the configration
+    inline config_t config() const
+    {
+        return _cfg;
+    }
+    //! @brief Set the configration
+    inline void config(const config_t& cfg)
+    {
+        _cfg = cfg;
+    }
+    ///@}
+
+    /*!
+      @brief Schedule frequency and phase change
+      @param at Deadline (us, same time base as the clock)
+      @param freq Frequency(Hz) 0 - 1Mhz
+      @param deg Phase (degree)
+      @return True if successful, false if the queue is full
+     */
+    bool schedule(const uint64_t at, const uint32_t freq, const uint16_t deg = 0)
+    {
+        if (_queue.size() >= _capacity) {
+            return false;
+        }
+        auto it = std::upper_bound(_queue.begin(), _queue.end(), at,
+                                   [](const uint64_t a, const command_t& c) { return a < c.at; });
+        if (it == _queue.begin()) {
+            // The prepared bank will be overwritten by the new front
+            _prepared = false;
+        }
+        command_t cmd{};
+        cmd.at   = at;
+        cmd.freq = freq;
+        cmd.deg  = deg;
+        _queue.insert(it, cmd);
+        return true;
+    }
+    /*!
+      @brief Prepare and execute the commands that are due
+      @return Number of flips issued
+     */
+    uint32_t update()
+    {
+        uint32_t count{};
+        while (!_queue.empty()) {
+            const command_t cmd = _queue.front();
+            uint64_t t          = now();
+
+            if (!_prepared) {
+                if (t + _cfg.lead_us < cmd.at) {
+                    break;
+                }
+                if (!prepare(cmd)) {
+                    ++_stat.failed;
+                    _queue.erase(_queue.begin());
+                    continue;
+                }
+                t = now();
+            }
+
+            if (t < cmd.at) {
+                if (cmd.at - t > _cfg.spin_us) {
+                    break;
+                }
+                while (now() < cmd.at) {
+                }
+            }
+
+            _queue.erase(_queue.begin());
+            _prepared = false;
+            if (!flip(cmd.at)) {
+                ++_stat.failed;
+                continue;
+            }
+            ++count;
+        }
+        return count;
+    }
+    //! @brief Discard all pending commands
+    inline void clear()
+    {
+        _queue.clear();
+        _prepared = false;
+    }
+
+    ///@name Properties
+    ///@{
+    //! @brief Gets the current time (us)
+    inline uint64_t now()
+    {
+        return _clock();
+    }
+    //! @brief Gets the number of pending commands
+    inline size_t pending() const
+    {
+        return _queue.size();
+    }
+    //! @brief Gets the next deadline (us), 0 if empty
+    inline uint64_t nextDeadline() const
+    {
+        return _queue.empty() ? 0 : _queue.front().at;
+    }
+    //! @brief Gets the statistics
+    inline const statistics_t& statistics() const
+    {
+        return _stat;
+    }
+    //! @brief Reset the statistics
+    inline void resetStatistics()
+    {
+        _stat = statistics_t{};
+    }
+    ///@}
+
+protected:
+    // Write the command to the inactive bank
+    bool prepare(const command_t& cmd)
+    {
+        // The cached CONTROL is unknown after a failed write, so it is read again
+        uint8_t ctrl{};
+        if (!_unit.controlValid() && !_unit.readControl(ctrl)) {
+            return false;
+        }
+        _bank = !_unit.currentFrequencyBank();
+        if (_unit.writeFrequencyAndPhase(_bank, cmd.freq, _bank, cmd.deg)) {
+            _prepared = true;
+            return true;
+        }
+        return false;
+    }
+    // Single CONTROL write, lateness at its completion
+    bool flip(const uint64_t at)
+    {
+        if (!_unit.writeCurrent(_bank, _bank)) {
+            return false;
+        }
+        const uint64_t t = now();
+        const uint32_t l = static_cast<uint32_t>(std::min<uint64_t>(t > at ? t - at : 0, UINT32_MAX));
+        ++_stat.executed;
+        _stat.total_lateness += l;
+        _stat.max_lateness = std::max(_stat.max_lateness, l);
+        if (l > _cfg.late_us) {
+            ++_stat.late;
+        }
+        return true;
+    }
+
+private:
+    Unit& _unit;
+    clock_function_t _clock{};
+    config_t _cfg{};
+    statistics_t _stat{};
+    std::vector<command_t> _queue{};  // Sorted by deadline
+    size_t _capacity{};
+    bool _prepared{};  // Is the front command in the inactive bank?
+    bool _bank{};      // Bank where the front command was written
+};
+
+/*!
+  @class m5::unit::dds::Scheduler
+  @brief BasicScheduler for UnitDDS
+ */
+class Scheduler : public BasicScheduler<UnitDDS> {
+public:
+    /*!
+      @param unit UnitDDS
+      @param capacity Maximum number of pending commands
+      @param clock Clock function, m5::utility::micros() based if nullptr
+     */
+    explicit Scheduler(UnitDDS& unit, const size_t capacity = 16, clock_function_t clock = nullptr);
+
+protected:
+    uint64_t micros64();
+
+private:
+    uint32_t _last_micros{};
+    uint64_t _micros{};
+};
+
+extern template class BasicScheduler<UnitDDS>;
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
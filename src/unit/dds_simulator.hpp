@@ -0,0 +1,173 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_simulator.hpp
+  @brief In-memory simulator of the UnitDDS firmware
+  @details Bus backend for BasicUnitDDS without hardware, e.g. native tests
+*/
+#ifndef M5_UNIT_DDS_DDS_SIMULATOR_HPP
+#define M5_UNIT_DDS_DDS_SIMULATOR_HPP
+
+#include "dds_codec.hpp"
+#include <cstddef>
+#include <cstring>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+namespace bus {
+
+/*!
+  @class m5::unit::dds::bus::Simulator
+  @brief Register model of the firmware
+  @details
+  - MODE and CONTROL accept only bytes with the write flag, and are written consecutively in a burst
+  - FREQUENCY frames are followed by a PHASE frame in a burst, the bank is selected by each frame
+  - Entering Sawtooth/DC clears both frequencies as the firmware does
+  - Faults are injected per transaction, either not applied (failNext) or applied without ACK (loseAckNext)
+ */
+class Simulator {
+public:
+    ///@name Bus
+    ///@{
+    bool write(const uint8_t reg, const uint8_t* buf, const size_t len)
+    {
+        if (fail()) {
+            return false;
+        }
+        ++_writes;
+        const bool lost = lose();
+        uint8_t r{reg};
+        size_t i{};
+        while (i < len) {
+            if ((r == command::MODE_REG || r == command::CONTROL_REG) && (buf[i] & codec::WRITE_FLAG)) {
+                write8(r, buf[i] & 0x7F);
+                ++r;
+                ++i;
+            } else if (r == command::FREQUENCY_REG && i + 4 <= len) {
+                _ftw[(buf[i] & 0x40) ? 1 : 0] =
+                    ((uint32_t)(buf[i] & 0x0F) << 24) | ((uint32_t)buf[i + 1] << 16) | (buf[i + 2] << 8) | buf[i + 3];
+                r = command::PHASE_REG;
+                i += 4;
+            } else if (r == command::PHASE_REG && i + 2 <= len) {
+                _phase[(buf[i] & 0x40) ? 1 : 0] = ((buf[i] & 0x07) << 8) | buf[i + 1];
+                r                               = 0;
+                i += 2;
+            } else {
+                break;
+            }
+        }
+        return !lost;
+    }
+    bool read(const uint8_t reg, uint8_t* buf, const size_t len)
+    {
+        if (fail()) {
+            return false;
+        }
+        ++_reads;
+        std::memset(buf, 0, len);
+        if (reg == command::READ_DESCRIPTION_REG) {
+            std::memcpy(buf, codec::DESC, len < 6 ? len : 6);
+        } else if (reg == command::MODE_REG || reg == command::CONTROL_REG) {
+            for (size_t i = 0; i < len && reg + i <= command::CONTROL_REG; ++i) {
+                buf[i] = (reg + i == command::MODE_REG) ? _mode : _ctrl;
+            }
+        }
+        return true;
+    }
+    ///@}
+
+    ///@name Register state
+    ///@{
+    inline uint8_t mode() const
+    {
+        return _mode;
+    }
+    inline uint8_t control() const
+    {
+        return _ctrl;
+    }
+    inline uint32_t ftw(const bool select) const
+    {
+        return _ftw[select];
+    }
+    inline uint16_t phase(const bool select) const
+    {
+        return _phase[select];
+    }
+    ///@}
+
+    ///@name Fault injection and counters
+    ///@{
+    //! @brief The next n transactions fail
+    inline void failNext(const uint32_t n)
+    {
+        _fail = n;
+    }
+    //! @brief The next n writes are applied but fail (lost ACK)
+    inline void loseAckNext(const uint32_t n)
+    {
+        _lose = n;
+    }
+    //! @brief Clear the pending faults
+    inline void clearFaults()
+    {
+        _fail = _lose = 0;
+    }
+    inline uint32_t writes() const
+    {
+        return _writes;
+    }
+    inline uint32_t reads() const
+    {
+        return _reads;
+    }
+    inline void resetCounters()
+    {
+        _writes = _reads = 0;
+    }
+    ///@}
+
+private:
+    bool fail()
+    {
+        if (_fail) {
+            --_fail;
+            return true;
+        }
+        return false;
+    }
+    bool lose()
+    {
+        if (_lose) {
+            --_lose;
+            return true;
+        }
+        return false;
+    }
+    void write8(const uint8_t reg, const uint8_t v)
+    {
+        if (reg == command::MODE_REG) {
+            _mode = v;
+            if (codec::is_frequency_ignored(static_cast<Mode>(v & 0x07))) {
+                _ftw[0] = _ftw[1] = 0;
+            }
+        } else {
+            _ctrl = v;
+        }
+    }
+
+    uint8_t _mode{}, _ctrl{};
+    uint32_t _ftw[2]{};
+    uint16_t _phase[2]{};
+    uint32_t _fail{}, _lose{}, _writes{}, _reads{};
+};
+
+}  // namespace bus
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
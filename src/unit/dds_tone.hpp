@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file dds_tone.hpp
+  @brief Tone frames for UnitDDS::playTones
+  @details Frames are constexpr, a melody table is converted to FTW at compile time
+  @code
+  constexpr m5::unit::dds::Tone alert[] = {
+      m5::unit::dds::note(81, 150),  // A5
+      m5::unit::dds::rest(50),
+      m5::unit::dds::tone(2000, 300),
+      m5::unit::dds::rest(500),
+  };
+  unit.playTones(alert, true);  // Driven by Units.update()
+  @endcode
+*/
+#ifndef M5_UNIT_DDS_DDS_TONE_HPP
+#define M5_UNIT_DDS_DDS_TONE_HPP
+
+#include "dds_codec.hpp"
+
+namespace m5 {
+namespace unit {
+namespace dds {
+
+//! @brief Rest flag of Tone::word
+constexpr uint32_t TONE_REST{0x80000000};
+
+/*!
+  @struct Tone
+  @brief Packed tone frame
+ */
+struct Tone {
+    uint32_t word;  //!< FTW (bit 0-27) or TONE_REST
+    uint16_t ms;    //!< Duration (ms)
+
+    //! @brief Is the rest?
+    constexpr bool isRest() const
+    {
+        return word & TONE_REST;
+    }
+    //! @brief Gets the FTW
+    constexpr uint32_t ftw() const
+    {
+        return word & FTW_MAX;
+    }
+};
+
+/*!
+  @brief Tone frame of the MIDI note
+  @param midi MIDI note number 0 - 127 (69 is A4 440Hz)
+  @param ms Duration (ms)
+ */
+constexpr Tone note(const uint8_t midi, const uint16_t ms)
+{
+    return Tone{midi_to_ftw(midi), ms};
+}
+///@cond
+namespace detail {
+// Not constexpr, so an out of range tone in a constant expression fails to compile
+inline void tone_frequency_out_of_range()
+{
+}
+}  // namespace detail
+///@endcond
+
+/*!
+  @brief Tone frame of the frequency
+  @param hz Frequency (Hz) 0 - 1MHz
+  @param ms Duration (ms)
+  @note Out of range frequency is a compile error in a constant expression,
+  otherwise the frame has an invalid FTW and is rejected by UnitDDS::playTones
+ */
+constexpr Tone tone(const uint32_t hz, const uint16_t ms)
+{
+    return codec::is_valid_frequency(hz) ? Tone{frequency_to_ftw(hz), ms}
+                                         : (detail::tone_frequency_out_of_range(), Tone{FTW_MAX, ms});
+}
+/*!
+  @brief Rest frame
+  @param ms Duration (ms)
+  @note The DAC sleeps during the rest, the same as UnitDDS::sleep(false, true)
+ */
+constexpr Tone rest(const uint16_t ms)
+{
+    return Tone{TONE_REST, ms};
+}
+
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -10,40 +10,18 @@
 #include "unit_DDS.hpp"
 #include <M5Utility.hpp>
 #include <cmath>
+#include <algorithm>
 
 using namespace m5::utility::mmh3;
 using namespace m5::unit::types;
 using namespace m5::unit::dds;
 using namespace m5::unit::dds::command;
+using namespace m5::unit::dds::codec;
 
 namespace {
 
-constexpr char DESC[] = "ad9833";
-constexpr double MCLK{10000000.f};
-constexpr uint32_t MINIMUM_FREQ{0};
-constexpr uint32_t MAXIMUM_FREQ{1000000};
-
-// Calculate 28-bit FTW from out[Hz] to be output
-uint32_t calculate_ftw(const uint32_t out_hz)
-{
-    constexpr double scale = static_cast<double>(1ULL << 28);
-    uint32_t ftw           = static_cast<uint32_t>(llround(static_cast<double>(out_hz) * scale / MCLK));
-    return ftw & 0x0FFFFFFF;
-}
-
-// Calculate 11-bit PHASE from phase[deg]
-uint16_t calculate_phase(const uint16_t deg)
-{
-    uint16_t d  = deg % 360;
-    uint16_t pw = static_cast<uint16_t>(lround(d * (2048.0f / 360.0f)));
-    return pw & 0x7FF;
-}
-
-inline bool is_valid_frequency(const uint32_t freq)
-{
-    //    return std::isfinite(freq) && freq >= MINIMUM_FREQ && freq <= MAXIMUM_FREQ;
-    return std::isfinite(freq) && freq <= MAXIMUM_FREQ;
-}
+// Transactions of resync and the retried one after recovery
+constexpr uint32_t RESYNC_TRANSACTIONS{4 + 1};
 
 }  // namespace
 
@@ -56,212 +34,792 @@ const types::attr_t UnitDDS::attr{attribute::AccessI2C};
 
 bool UnitDDS::begin()
 {
-    char desc[7]{};
-    if (!readDescription(desc)) {
-        M5_LIB_LOGE("Failed to read description");
+    Guard lock(*this);
+    if (_cfg.check_description) {
+        char desc[7]{};
+        if (!readDescription(desc)) {
+            M5_LIB_LOGE("Failed to read description");
+            return false;
+        }
+        if (strcmp(desc, DESC)) {
+            M5_LIB_LOGE("Illegal desc [%s]", desc);
+            return false;
+        }
+    }
+    return _cfg.start_output ? program(_cfg.mode, _cfg.select, _cfg.freq, _cfg.deg, _cfg.hold_reset) : true;
+}
+
+void UnitDDS::update(const bool force)
+{
+    (void)force;
+
+    // Idle power management, not while a tone is playing without writes
+    if (_idle_ms && !_idle_sleeping && !_tones && m5::utility::millis() - _last_activity >= _idle_ms) {
+        Guard lock(*this);
+        // Not if already sleeping by the user
+        if (!(_core.controlValid() && (_core.control() & (CTRL_SLEEP1 | CTRL_SLEEP12))) &&
+            _core.updateControl(CTRL_SLEEP1 | CTRL_SLEEP12, _idle_bits)) {
+            _idle_sleeping = true;
+            _sleep_at      = m5::utility::millis();
+            ++_power_stat.sleeps;
+        } else {
+            _last_activity = m5::utility::millis();
+        }
+    }
+
+    // Tone player
+    if (_tones) {
+        Guard lock(*this);
+        if (_tones && m5::utility::millis() - _tone_start >= _tone_ms) {
+            _tone_start += _tone_ms;
+            if (_tone_index >= _tone_count) {
+                _tones = nullptr;
+                touch();  // Idle counts from the end of the sequence
+            } else {
+                start_tone();
+            }
+        }
+    }
+
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+    if (!_sequences.empty()) {
+        Guard lock(*this);
+        auto now = m5::utility::millis();
+        // Index access because a sequence may run another one
+        for (size_t i = 0; i < _sequences.size(); ++i) {
+            _sequences[i].resume(now);
+        }
+        _sequences.erase(std::remove_if(_sequences.begin(), _sequences.end(),
+                                        [](const dds::Sequence& s) { return s.done(); }),
+                         _sequences.end());
+    }
+#endif
+}
+
+bool UnitDDS::playTones(const dds::Tone* tones, const size_t count, const bool loop)
+{
+    Guard lock(*this);
+    _tones = nullptr;
+    if (!tones || !count) {
+        M5_LIB_LOGE("No frames");
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!tones[i].isRest() && !is_valid_ftw(tones[i].ftw())) {
+            M5_LIB_LOGE("Frame %zu exceeds %u Hz", i, MAXIMUM_FREQ);
+            return false;
+        }
+    }
+
+    // The inactive bank is decided by the CONTROL shadow
+    if (!_core.syncControl()) {
         return false;
     }
-    if (strcmp(desc, DESC)) {
-        M5_LIB_LOGE("Illegal desc [%s]", desc);
+
+    _tones         = tones;
+    _tone_count    = count;
+    _tone_index    = 0;
+    _tone_loop     = loop;
+    _tone_prepared = false;
+    _tone_start    = m5::utility::millis();
+    if (!start_tone()) {
+        _tones = nullptr;
         return false;
     }
-    return _cfg.start_output ? writeOutput(_cfg.mode, _cfg.select, _cfg.freq, _cfg.deg) && wakeup() : true;
+    return true;
+}
+
+// Write the next tone to the inactive bank
+bool UnitDDS::prepare_tone()
+{
+    const auto& t  = _tones[_tone_index];
+    _tone_prepared = t.isRest() || writeFrequencyWord(!_core.currentFrequencyBank(), t.ftw());
+    return _tone_prepared;
+}
+
+// Switch to the next frame with a single CONTROL write, and prepare the following one
+bool UnitDDS::start_tone()
+{
+    const auto& t = _tones[_tone_index];
+    _tone_ms      = t.ms;
+    touch();
+
+    bool ok{};
+    if (t.isRest()) {
+        ok = _core.updateControl(CTRL_SLEEP12, CTRL_SLEEP12);
+    } else if (_tone_prepared || prepare_tone()) {
+        // Flip the bank and wake the DAC at once
+        ok = _core.updateControl(CTRL_FSELECT | CTRL_SLEEP12, _core.currentFrequencyBank() ? 0x00 : CTRL_FSELECT);
+    }
+    _tone_prepared = false;
+
+    if (++_tone_index >= _tone_count && _tone_loop) {
+        _tone_index = 0;
+    }
+    if (_tone_index < _tone_count) {
+        prepare_tone();
+    }
+    return ok;
 }
 
 bool UnitDDS::readDescription(char str[7])
 {
+    Guard lock(*this);
     if (!str) {
         return false;
     }
-    str[0] = '\0';
-
-    uint8_t rbuf[6]{};
-    if (readRegister(READ_DESCRIPTION_REG, rbuf, m5::stl::size(rbuf), 0)) {
-        memcpy((uint8_t*)str, rbuf, m5::stl::size(rbuf));
-        str[m5::stl::size(rbuf)] = '\0';
-        return true;
-    }
-    return false;
+    return _core.readDescription(str);
 }
 
 bool UnitDDS::readMode(Mode& mode)
 {
+    Guard lock(*this);
     mode = Mode::Reserved;
-    uint8_t v{};
-    if (readRegister8(MODE_REG, v, 0)) {
-        mode = static_cast<Mode>(v & 0x07);
-        return true;
-    }
-    return false;
+    return _core.readMode(mode);
 }
 
 bool UnitDDS::writeMode(const Mode mode)
 {
-    uint8_t v{};
-    uint8_t ctrl{};
-    if (readRegister8(MODE_REG, v, 0) && read_control(ctrl)) {
-        Mode old        = (Mode)(v & 0x07);
-        bool write_freq = (old == Mode::Sawtooth || old == Mode::DC) && (mode != Mode::Sawtooth && mode != Mode::DC);
-        v               = (v & ~0x07) | m5::stl::to_underlying(mode);
-        // *** From Firmware Implementation ***
-        // Ctrl must also be re-written to reflect the mode change
-        // When SAWTOOH/DC mode is selected, the internal ferq is set to 0, so it is set back.
-        return write_register8(MODE_REG, v) && write_register8(CONTROL_REG, ctrl) &&
-               (write_freq ? (writeFrequency0(_freq[0]) && writeFrequency1(_freq[1])) : true);
-    }
-    return false;
+    Guard lock(*this);
+    touch();
+    // *** From Firmware Implementation ***
+    // Ctrl must also be re-written to reflect the mode change
+    // When SAWTOOH/DC mode is selected, the internal ferq is set to 0, so it is set back.
+    return _core.writeMode(mode);
 }
 
 bool UnitDDS::writeFrequency(const bool select, const uint32_t freq)
 {
+    Guard lock(*this);
     if (!is_valid_frequency(freq)) {
         M5_LIB_LOGE("freq must be between %u and %u (%u)", MINIMUM_FREQ, MAXIMUM_FREQ, freq);
         return false;
     }
-    uint32_t ftw = calculate_ftw(freq);
-    uint8_t buf[4]{};
-    buf[0] = ((ftw >> 24) & 0x0F) | (select ? 0xC0 : 0x80);
-    buf[1] = (ftw >> 16) & 0xFF;
-    buf[2] = (ftw >> 8) & 0xFF;
-    buf[3] = ftw & 0xFF;
+    touch();
+    // The shadow keeps the previous value on failure, resync() will restore it
+    return _core.writeFrequency(select, freq);
+}
 
-    _freq[(int)select] = 0;
-    if (!writeRegister(FREQUENCY_REG, buf, m5::stl::size(buf))) {
+bool UnitDDS::writeFrequencyWord(const bool select, const uint32_t ftw)
+{
+    Guard lock(*this);
+    if (!is_valid_ftw(ftw)) {
+        M5_LIB_LOGE("ftw must be between 0 and %u (%u)", frequency_to_ftw(MAXIMUM_FREQ), ftw);
         return false;
     }
-    _freq[(int)select] = freq;
-    return true;
+    touch();
+    return _core.writeFrequencyWord(select, ftw);
+}
+
+bool UnitDDS::writeFrequencyFrame(const uint8_t frame[4])
+{
+    Guard lock(*this);
+    if (!(frame[0] & WRITE_FLAG) || !is_valid_ftw(decode_ftw(frame))) {
+        M5_LIB_LOGE("Invalid frame %02X:%02X:%02X:%02X", frame[0], frame[1], frame[2], frame[3]);
+        return false;
+    }
+    touch();
+    return _core.writeFrequencyFrame(frame);
 }
 
 bool UnitDDS::writePhase(const bool select, const uint16_t deg)
 {
-    uint16_t ph = calculate_phase(deg);
-    uint8_t buf[2]{};
-    buf[0] = ((ph >> 8) & 0x07) | (select ? 0xC0 : 0x80);
-    buf[1] = ph & 0xFF;
-    return writeRegister(PHASE_REG, buf, m5::stl::size(buf));
+    Guard lock(*this);
+    touch();
+    return _core.writePhase(select, deg);
 }
 
 bool UnitDDS::writeFrequencyAndPhase(const bool select_freq, const uint32_t freq, const bool select_phase,
                                      const uint16_t deg)
 {
+    Guard lock(*this);
     if (!is_valid_frequency(freq)) {
         M5_LIB_LOGE("freq must be between %u and %u (%u)", MINIMUM_FREQ, MAXIMUM_FREQ, freq);
         return false;
     }
-
-    uint32_t ftw = calculate_ftw(freq);
-    uint16_t ph  = calculate_phase(deg);
-    uint8_t buf[6]{};
-    buf[0] = ((ftw >> 24) & 0x0F) | (select_freq ? 0xC0 : 0x80);
-    buf[1] = (ftw >> 16) & 0xFF;
-    buf[2] = (ftw >> 8) & 0xFF;
-    buf[3] = ftw & 0xFF;
-    buf[4] = ((ph >> 8) & 0x07) | (select_phase ? 0xC0 : 0x80);
-    buf[5] = ph & 0xFF;
-    // M5_LIB_LOGE("%02X:%02X:%02X:%02X:%02X:%02X", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]);
-
-    _freq[(int)select_freq] = 0;
-    if (writeRegister(FREQUENCY_REG, buf, m5::stl::size(buf))) {
-        _freq[(int)select_freq] = freq;
-        return true;
-    }
-    return false;
+    touch();
+    return _core.writeFrequencyAndPhase(select_freq, freq, select_phase, deg);
 }
 
 bool UnitDDS::writeCurrent(const bool select_freq, const bool select_phase)
 {
-    uint8_t ctrl{};
-    if (read_control(ctrl)) {
-        ctrl &= ~0x60;
-        ctrl |= select_freq ? 0x40 : 0x00;
-        ctrl |= select_phase ? 0x20 : 0x00;
-        return write_register8(CONTROL_REG, ctrl);
-    }
-    return false;
+    Guard lock(*this);
+    touch();
+    return _core.writeCurrent(select_freq, select_phase);
 }
 
 bool UnitDDS::writeCurrentFrequency(const bool select)
 {
-    uint8_t ctrl{};
-    if (read_control(ctrl)) {
-        ctrl &= ~0x40;
-        ctrl |= select ? 0x40 : 0x00;
-        return write_register8(CONTROL_REG, ctrl);
-    }
-    return false;
+    Guard lock(*this);
+    touch();
+    return _core.writeCurrentFrequency(select);
 }
 
 bool UnitDDS::writeCurrentPhase(const bool select)
 {
-    uint8_t ctrl{};
-    if (read_control(ctrl)) {
-        ctrl &= ~0x20;
-        ctrl |= select ? 0x20 : 0x00;
-        return write_register8(CONTROL_REG, ctrl);
-    }
-    return false;
+    Guard lock(*this);
+    touch();
+    return _core.writeCurrentPhase(select);
 }
 
 bool UnitDDS::writeOutput(const dds::Mode mode, const bool select, const uint32_t freq, const uint16_t deg)
 {
+    Guard lock(*this);
     if (!is_valid_frequency(freq)) {
         M5_LIB_LOGE("freq must be between %u and %u (%u)", MINIMUM_FREQ, MAXIMUM_FREQ, freq);
         return false;
     }
-    return writeFrequencyAndPhase(select, freq, select, deg) && writeMode(mode) && writeCurrent(select, select);
+    touch();
+    return _core.writeOutput(mode, select, freq, deg);
+}
+
+size_t UnitDDS::writeBatch(const Op* ops, const size_t count, bool* results)
+{
+    Guard lock(*this);
+    if (!ops || !count) {
+        return 0;
+    }
+    size_t succeeded{};
+    auto set_result = [&results, &succeeded](const size_t idx, const bool r) {
+        if (results) {
+            results[idx] = r;
+        }
+        succeeded += r;
+    };
+
+    size_t i{};
+    while (i < count) {
+        const Op& op = ops[i];
+        switch (op.type) {
+            case Op::Type::Frequency:
+            case Op::Type::Phase: {
+                if (op.type == Op::Type::Frequency && !is_valid_frequency(op.value)) {
+                    M5_LIB_LOGE("freq must be between %u and %u (%u)", MINIMUM_FREQ, MAXIMUM_FREQ, op.value);
+                    set_result(i++, false);
+                    break;
+                }
+                // Frequency and phase in either order are merged into a single burst
+                const Op* next = (i + 1 < count) ? &ops[i + 1] : nullptr;
+                const bool merge =
+                    next && ((op.type == Op::Type::Frequency && next->type == Op::Type::Phase) ||
+                             (op.type == Op::Type::Phase && next->type == Op::Type::Frequency &&
+                              is_valid_frequency(next->value)));
+                if (merge) {
+                    const Op& f  = (op.type == Op::Type::Frequency) ? op : *next;
+                    const Op& p  = (op.type == Op::Type::Phase) ? op : *next;
+                    const bool r = writeFrequencyAndPhase(f.select, f.value, p.select, p.value);
+                    set_result(i++, r);
+                    set_result(i++, r);
+                    break;
+                }
+                set_result(i, (op.type == Op::Type::Frequency) ? writeFrequency(op.select, op.value)
+                                                               : writePhase(op.select, op.value));
+                ++i;
+            } break;
+            case Op::Type::Mode:
+            case Op::Type::Current:
+            case Op::Type::Sleep: {
+                if (op.type == Op::Type::Mode && !is_valid_mode(op.value)) {
+                    M5_LIB_LOGE("Invalid mode %u", op.value);
+                    set_result(i++, false);
+                    break;
+                }
+                touch();
+                // Fold the run of MODE/CONTROL operations into one write
+                bool r       = _core.syncControl();
+                uint8_t ctrl = _core.control();
+                uint8_t mv{};
+                bool has_mode{}, has_sleep{};
+                size_t j{i};
+                for (; j < count; ++j) {
+                    const Op& o = ops[j];
+                    if (o.type == Op::Type::Mode) {
+                        if (!is_valid_mode(o.value)) {
+                            break;  // Rejected as the head of the next run
+                        }
+                        has_mode = true;
+                        mv       = o.value & 0x07;
+                    } else if (o.type == Op::Type::Current) {
+                        ctrl = (ctrl & ~(CTRL_FSELECT | CTRL_PSELECT)) | (o.select ? CTRL_FSELECT : 0x00) |
+                               (o.select2 ? CTRL_PSELECT : 0x00);
+                    } else if (o.type == Op::Type::Sleep) {
+                        has_sleep = true;
+                        ctrl      = (ctrl & ~(CTRL_SLEEP1 | CTRL_SLEEP12)) | (o.select ? CTRL_SLEEP1 : 0x00) |
+                                    (o.select2 ? CTRL_SLEEP12 : 0x00);
+                    } else {
+                        break;
+                    }
+                }
+                if (has_sleep) {
+                    end_idle_sleep();  // Otherwise the idle bits are cleared by the write
+                }
+                if (r) {
+                    r = has_mode ? _core.writeModeAndControl((Mode)mv, ctrl) : _core.writeControl(ctrl);
+                }
+                for (; i < j; ++i) {
+                    set_result(i, r);
+                }
+            } break;
+            default:
+                set_result(i++, false);
+                break;
+        }
+    }
+    return succeeded;
 }
 
 bool UnitDDS::sleep(const bool mclk, const bool DAC)
 {
+    Guard lock(*this);
     if (!mclk && !DAC) {
         M5_LIB_LOGE("Sleep Target must be specified");
         return false;
     }
+    end_idle_sleep();
+    return _core.sleep(mclk, DAC);
+}
 
-    uint8_t ctrl{};
-    if (read_control(ctrl)) {
-        ctrl &= ~0x18;
-        ctrl |= mclk ? 0x10 : 0x00;
-        ctrl |= DAC ? 0x08 : 0x00;
-        return write_register8(CONTROL_REG, ctrl);
+bool UnitDDS::wakeup()
+{
+    Guard lock(*this);
+    touch();
+    // SLEEP1,2,RESET to 0
+    if (_core.wakeup()) {
+        // DAC outputs are enabled and updated 7 to 8 MCLK cycles after the RESET bit is set back to 0
+        // About 0.8 us if MCLK is 10Mhz
+        m5::utility::delayMicroseconds(2);  // A little longer
+        return true;
     }
     return false;
 }
 
-bool UnitDDS::wakeup()
+bool UnitDDS::reset()
+{
+    Guard lock(*this);
+    touch();
+    return _core.reset();
+}
+
+bool UnitDDS::key(const bool on)
+{
+    Guard lock(*this);
+    if (!on && _idle_sleeping) {
+        // Already silent, stay in idle sleep
+        return true;
+    }
+    touch();
+    return _core.updateControl(CTRL_SLEEP12, on ? 0x00 : CTRL_SLEEP12);
+}
+
+bool UnitDDS::writeReset(const bool hold)
 {
-    uint8_t ctrl{};
-    if (read_control(ctrl)) {
-        ctrl &= ~0x1C;  // SLEEP1,2,RESET to 0
-        if (write_register8(CONTROL_REG, ctrl)) {
-            // DAC outputs are enabled and updated 7 to 8 MCLK cycles after the RESET bit is set back to 0
-            // About 0.8 us if MCLK is 10Mhz
-            m5::utility::delayMicroseconds(2);  // A little longer
-            return true;
+    Guard lock(*this);
+    touch();
+    return _core.updateControl(CTRL_SLEEP1 | CTRL_SLEEP12 | CTRL_RESET, hold ? CTRL_RESET : 0x00);
+}
+
+bool UnitDDS::program(const dds::Mode mode, const bool select, const uint32_t freq, const uint16_t deg,
+                      const bool hold)
+{
+    Guard lock(*this);
+    if (!is_valid_frequency(freq)) {
+        M5_LIB_LOGE("freq must be between %u and %u (%u)", MINIMUM_FREQ, MAXIMUM_FREQ, freq);
+        return false;
+    }
+    touch();
+    // Every register is written, so nothing is read
+    return _core.program(mode, select, freq, deg, hold);
+}
+
+void UnitDDS::idleSleep(const uint32_t idle_ms, const bool mclk, const bool DAC)
+{
+    Guard lock(*this);
+    _idle_ms       = (mclk || DAC) ? idle_ms : 0;
+    _idle_bits     = (mclk ? CTRL_SLEEP1 : 0x00) | (DAC ? CTRL_SLEEP12 : 0x00);
+    _last_activity = m5::utility::millis();
+}
+
+bool UnitDDS::writeUrgent(const dds::Op& op)
+{
+    uint8_t mask{}, bits{};
+    switch (op.type) {
+        case Op::Type::Current:
+            mask = CTRL_FSELECT | CTRL_PSELECT;
+            bits = (op.select ? CTRL_FSELECT : 0x00) | (op.select2 ? CTRL_PSELECT : 0x00);
+            break;
+        case Op::Type::Sleep:
+            mask = CTRL_SLEEP1 | CTRL_SLEEP12;
+            bits = (op.select ? CTRL_SLEEP1 : 0x00) | (op.select2 ? CTRL_SLEEP12 : 0x00);
+            break;
+        default:
+            M5_LIB_LOGE("Only Current and Sleep are urgent");
+            return false;
+    }
+    // Merged with the request not written yet
+    uint32_t cur = _urgent.load(std::memory_order_relaxed);
+    uint32_t req{};
+    do {
+        const uint8_t m = ((cur >> 8) & 0xFF) | mask;
+        const uint8_t b = ((cur & 0xFF) & ~mask) | bits;
+        req             = ((uint32_t)m << 8) | b;
+    } while (!_urgent.compare_exchange_weak(cur, req, std::memory_order_seq_cst, std::memory_order_relaxed));
+    if (!cur) {
+        _urgent_at.store(m5::utility::micros(), std::memory_order_relaxed);
+    }
+
+    // Otherwise written by the call in progress
+    if (_thread_safe && !_bus_mutex.try_lock()) {
+        return true;
+    }
+    // The lock is recursive, the call in progress may be on this task (e.g. from its callback)
+    if (_depth != 0) {
+        if (_thread_safe) {
+            _bus_mutex.unlock();
         }
+        return true;
     }
-    return false;
+    bool r{};
+    {
+        Guard lock(*this);
+        r = service_urgent(false);
+    }
+    if (_thread_safe) {
+        _bus_mutex.unlock();
+    }
+    return r;
 }
 
-bool UnitDDS::reset()
+bool UnitDDS::readControl(uint8_t& ctrl)
+{
+    Guard lock(*this);
+    return _core.readControl(ctrl);
+}
+
+bool UnitDDS::writeModeAndControl(const Mode mode, const uint8_t ctrl)
 {
-    uint8_t ctrl{};
-    if (read_control(ctrl)) {
-        ctrl |= 0x04;
-        return write_register8(CONTROL_REG, ctrl);
+    Guard lock(*this);
+    return _core.writeModeAndControl(mode, ctrl);
+}
+
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+void UnitDDS::run(dds::Sequence&& seq)
+{
+    if (!seq.done()) {
+        _sequences.emplace_back(std::move(seq));
     }
-    return false;
+}
+#endif
+
+bool UnitDDS::ComponentBus::write(const uint8_t reg, const uint8_t* buf, const size_t len)
+{
+    return _u->write_bus(reg, buf, len);
+}
+
+bool UnitDDS::ComponentBus::read(const uint8_t reg, uint8_t* buf, const size_t len)
+{
+    return _u->read_register(reg, buf, len);
+}
+
+uint8_t UnitDDS::ComponentBus::controlToWrite(const uint8_t ctrl)
+{
+    return _u->control_to_write(ctrl);
+}
+
+// CONTROL to write instead of value
+uint8_t UnitDDS::control_to_write(const uint8_t value) const
+{
+    // Bits of the urgent command win over the call in progress
+    const uint8_t v = (value & ~_urgent_mask) | _urgent_bits;
+    // Wake from idle sleep in the same write
+    return _idle_sleeping ? (v & ~_idle_bits) : v;
+}
+
+// Write of the driver core, MODE and CONTROL are verified
+bool UnitDDS::write_bus(const uint8_t reg, const uint8_t* buf, const size_t len)
+{
+    if (!write_register(reg, buf, len)) {
+        return false;
+    }
+    if (reg != MODE_REG && reg != CONTROL_REG) {
+        return true;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (!verify_register8(reg + i, buf[i])) {
+            return false;
+        }
+    }
+    // CONTROL is written with the idle bits cleared (See also control_to_write)
+    if (_idle_sleeping && reg + len > CONTROL_REG) {
+        woken();
+    }
+    return true;
+}
+
+// Write the requested urgent command, true if none
+bool UnitDDS::service_urgent(const bool preempt)
+{
+    const uint32_t req = _urgent.exchange(0, std::memory_order_acquire);
+    if (!req) {
+        return true;
+    }
+    const uint8_t mask = (req >> 8) & 0xFF;
+    const uint8_t bits = req & 0xFF;
+    if (mask & (CTRL_SLEEP1 | CTRL_SLEEP12)) {
+        end_idle_sleep();
+    }
+    _urgent_mask = mask | _urgent_mask;
+    _urgent_bits = (_urgent_bits & ~mask) | bits;
+
+    const bool r = _core.updateControl(mask, bits);
+    ++_urgent_stat.commands;
+    _urgent_stat.preempted += preempt;
+    _urgent_stat.failed += !r;
+    _urgent_stat.last_latency_us = m5::utility::micros() - _urgent_at.load(std::memory_order_relaxed);
+    _urgent_stat.max_latency_us  = std::max(_urgent_stat.max_latency_us, _urgent_stat.last_latency_us);
+    return r;
+}
+
+void UnitDDS::verification(const Verify mode, const uint32_t interval)
+{
+    _verify          = mode;
+    _verify_interval = interval ? interval : 1;
+    _verify_count    = 0;
+}
+
+// Readback depending on the verification mode
+bool UnitDDS::verify_register8(const uint8_t reg, const uint8_t v)
+{
+    if (_verify == Verify::Never || _recovering) {
+        return true;
+    }
+    if (_verify == Verify::Sampled && ++_verify_count < _verify_interval) {
+        return true;
+    }
+    _verify_count = 0;
+
+    uint8_t actual{};
+    if (!read_register(reg, &actual, 1)) {
+        return false;
+    }
+    ++_verify_stat.verified;
+    const uint8_t expected = v & 0x7F;
+    actual &= 0x7F;
+    if (actual != expected) {
+        ++_verify_stat.mismatches;
+        M5_LIB_LOGW("Mismatch %02X: %02X/%02X", reg, expected, actual);
+        if (_mismatch_cb) {
+            _mismatch_cb(reg, expected, actual);
+        }
+        return false;
+    }
+    return true;
+}
+
+UnitDDS::Guard::Guard(UnitDDS& u) : _u(u)
+{
+    if (_u._thread_safe) {
+        _u._bus_mutex.lock();
+    }
+    ++_u._depth;
+}
+
+UnitDDS::Guard::~Guard()
+{
+    // Urgent commands are written between the API calls (the shadow is consistent there, not while recovering),
+    // and none is left when leaving the outermost call
+    if (!_u._recovering && _u._urgent.load(std::memory_order_seq_cst)) {
+        _u.service_urgent(_u._depth > 1);
+    }
+    const bool outermost = (--_u._depth == 0);
+    if (outermost) {
+        // Output command without CONTROL write while idle sleeping
+        if (_u._idle_sleeping && _u._touched) {
+            _u._core.updateControl(0x00, 0x00);
+        }
+        _u._touched     = false;
+        _u._urgent_mask = _u._urgent_bits = 0;
+        _u.publish();
+    }
+    if (_u._thread_safe) {
+        _u._bus_mutex.unlock();
+        // Requested by another task after the drain above, which failed to take the lock
+        if (outermost && _u._urgent.load(std::memory_order_seq_cst) && _u._bus_mutex.try_lock()) {
+            {
+                Guard lock(_u);
+            }
+            _u._bus_mutex.unlock();
+        }
+    }
+}
+
+// Output command
+void UnitDDS::touch()
+{
+    if (_idle_sleeping && !_touched) {
+        _touch_us = m5::utility::micros();
+    }
+    _touched       = true;
+    _last_activity = m5::utility::millis();
+}
+
+// Sleep by the user (or wake by the user) takes over the idle sleep, it is not woken automatically
+void UnitDDS::end_idle_sleep()
+{
+    if (_idle_sleeping) {
+        _power_stat.sleeping_ms += m5::utility::millis() - _sleep_at;
+        _idle_sleeping = false;
+    }
+}
+
+// Woken from idle sleep
+void UnitDDS::woken()
+{
+    // DAC outputs are enabled and updated 7 to 8 MCLK cycles after wake up (See also wakeup())
+    m5::utility::delayMicroseconds(2);
+
+    _idle_sleeping = false;
+    _power_stat.sleeping_ms += m5::utility::millis() - _sleep_at;
+    if (_touched) {
+        ++_power_stat.wakes;
+        _power_stat.last_wake_us = static_cast<uint32_t>(m5::utility::micros() - _touch_us);
+        _power_stat.max_wake_us  = std::max(_power_stat.max_wake_us, _power_stat.last_wake_us);
+    }
+}
+
+// Seqlock writer, serialized by the bus lock
+void UnitDDS::publish()
+{
+    const uint32_t seq = _seq.load(std::memory_order_relaxed);
+    _seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _snap[0].store(((uint32_t)m5::stl::to_underlying(_core.mode()) << 8) | _core.control(), std::memory_order_relaxed);
+    _snap[1].store(_core.frequency(false), std::memory_order_relaxed);
+    _snap[2].store(_core.frequency(true), std::memory_order_relaxed);
+    _snap[3].store(((uint32_t)_core.phase(true) << 16) | _core.phase(false), std::memory_order_relaxed);
+    _seq.store(seq + 2, std::memory_order_release);
+}
+
+// Seqlock reader
+snapshot_t UnitDDS::snapshot() const
+{
+    uint32_t seq{}, w[4]{};
+    do {
+        seq = _seq.load(std::memory_order_acquire);
+        for (uint_fast8_t i = 0; i < 4; ++i) {
+            w[i] = _snap[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != _seq.load(std::memory_order_relaxed));
+
+    snapshot_t ss{};
+    ss.mode    = static_cast<Mode>((w[0] >> 8) & 0x07);
+    ss.control = w[0] & 0xFF;
+    ss.freq[0] = w[1];
+    ss.freq[1] = w[2];
+    ss.deg[0]  = w[3] & 0xFFFF;
+    ss.deg[1]  = w[3] >> 16;
+    return ss;
+}
+
+bool UnitDDS::read_register(const uint8_t reg, uint8_t* buf, const size_t len)
+{
+    return with_retry([&]() { return read_transaction(reg, buf, len); });
 }
 
-bool UnitDDS::read_control(uint8_t& ctrl)
+bool UnitDDS::write_register(const uint8_t reg, const uint8_t* buf, const size_t len)
 {
-    return readRegister8(CONTROL_REG, ctrl, 0);
+    return with_retry([&]() { return write_transaction(reg, buf, len); });
 }
 
-bool UnitDDS::write_register8(const uint8_t reg, const uint8_t v)
+template <typename F>
+bool UnitDDS::with_retry(F func)
 {
-    return writeRegister8(reg, v | 0x80);
+    const auto start = m5::utility::micros();
+    // Single attempt while recovering to keep the worst-case latency bounded
+    const uint8_t attempts = _recovering ? 1 : std::max<uint8_t>(_retry.max_attempts, 1);
+    uint32_t backoff{_retry.backoff_us};
+    bool result{};
+
+    for (uint8_t i = 0; i < attempts; ++i) {
+        if (i) {
+            if (_retry.deadline_us && (m5::utility::micros() - start) + backoff > _retry.deadline_us) {
+                break;
+            }
+            ++_retry_stat.retries;
+            if (backoff) {
+                m5::utility::delayMicroseconds(backoff);
+            }
+            backoff = std::min<uint32_t>(backoff * 2, _retry.max_backoff_us);
+        }
+        if ((result = func())) {
+            break;
+        }
+    }
+
+    if (!result && !_recovering) {
+        ++_retry_stat.failures;
+        if (_retry.recover) {
+            _recovering = true;
+            if (_retry.recover() && resync()) {
+                ++_retry_stat.recoveries;
+                result = func();
+            }
+            _recovering = false;
+        }
+    }
+
+    if (!_recovering) {
+        _retry_stat.max_latency =
+            std::max<uint32_t>(_retry_stat.max_latency, static_cast<uint32_t>(m5::utility::micros() - start));
+    }
+    return result;
+}
+
+uint32_t UnitDDS::worstCaseLatency(const uint32_t transaction_us) const
+{
+    const uint8_t attempts = std::max<uint8_t>(_retry.max_attempts, 1);
+    uint64_t latency{transaction_us};
+    uint64_t backoff{_retry.backoff_us};
+    for (uint8_t i = 1; i < attempts; ++i) {
+        latency += backoff + transaction_us;
+        backoff = std::min<uint64_t>(backoff * 2, _retry.max_backoff_us);
+    }
+    if (_retry.deadline_us) {
+        // The last attempt may start just before the deadline
+        latency = std::min<uint64_t>(latency, (uint64_t)_retry.deadline_us + transaction_us);
+    }
+    if (_retry.recover) {
+        latency += _retry.recover_us + (uint64_t)RESYNC_TRANSACTIONS * transaction_us;
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(latency, UINT32_MAX));
+}
+
+bool UnitDDS::resync()
+{
+    Guard lock(*this);
+    return _core.resync();
+}
+
+bool UnitDDS::probeLink(const uint32_t trials, uint32_t& errors)
+{
+    Guard lock(*this);
+    errors = 0;
+    if (!_core.controlValid()) {
+        M5_LIB_LOGE("CONTROL is unknown");
+        return false;
+    }
+    // Same value as the device, the output does not change
+    const uint8_t ctrl = _core.control() | 0x80;
+    const uint8_t mode = m5::stl::to_underlying(_core.mode());
+    for (uint32_t i = 0; i < trials; ++i) {
+        uint8_t rbuf[6]{};
+        errors += !write_transaction(CONTROL_REG, &ctrl, 1);
+        errors += !(read_transaction(MODE_REG, rbuf, 1) && (rbuf[0] & 0x07) == mode);
+        errors += !(read_transaction(CONTROL_REG, rbuf, 1) && (rbuf[0] & 0x7F) == _core.control());
+        errors += !(read_transaction(READ_DESCRIPTION_REG, rbuf, m5::stl::size(rbuf)) &&
+                    memcmp(rbuf, DESC, m5::stl::size(rbuf)) == 0);
+    }
+    return true;
 }
 
 }  // namespace unit
@@ -11,6 +11,28 @@
 #define M5_UNIT_DDS_UNIT_DDS_HPP
 
 #include <M5UnitComponent.hpp>
+#include "dds_codec.hpp"
+#include "dds_basic.hpp"
+#include "dds_tone.hpp"
+#include "dds_coroutine.hpp"
+#include <functional>
+#include <atomic>
+#include <mutex>
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+#include <vector>
+#endif
+// Transactions are overridable only in the test build (e.g. over the simulator), inlined otherwise
+#if defined(M5_UNIT_DDS_TEST_TRANSPORT)
+#define M5_UNIT_DDS_TRANSPORT virtual
+#else
+#define M5_UNIT_DDS_TRANSPORT inline
+#endif
+#if __cplusplus >= 202002L
+#if __has_include(<span>)
+#include <span>
+#define M5_UNIT_DDS_ENABLE_SPAN
+#endif
+#endif
 
 namespace m5 {
 namespace unit {
@@ -22,17 +44,137 @@ namespace unit {
 namespace dds {
 
 /*!
-  @enum Mode
-  @brief Output mode
+  @struct retry_policy_t
+  @brief Retry and bus recovery policy for each I2C transaction
+  @note Each attempt itself is bounded by the timeout of the I2C driver
+  @note The library provides no default recovery, as it depends on the I2C driver and pins the unit is attached to.
+  Set recover to a function that frees the bus (e.g. clocking out SCL and reinitializing the driver);
+  the cached settings are written back by resync after it succeeds
+ */
+struct retry_policy_t {
+    uint8_t max_attempts{1};          //!< Attempts per transaction (1 means no retry)
+    uint32_t deadline_us{0};          //!< No retry is started after this time from the first attempt (0: no limit)
+    uint32_t backoff_us{0};           //!< Wait before the first retry, doubled each retry (us)
+    uint32_t max_backoff_us{1000};    //!< Upper limit of the wait (us)
+    std::function<bool()> recover{};  //!< Caller-provided bus recovery called when all attempts failed (nullptr: none)
+    uint32_t recover_us{0};           //!< Worst-case time of recover for budgeting (us)
+};
+
+/*!
+  @struct snapshot_t
+  @brief Consistent snapshot of the cached configuration
  */
-enum class Mode : uint8_t {
-    Reserved,  //!< Reserved
-    Sin,       //!< Sin wave
-    Triangle,  //!< Triangle wave
-    Square,    //!< Square wave
-    Sawtooth,  //!< Sawtooth wave (M5 extension)
-               //!< Fixed at frequency 13600 and phase 0
-    DC,        //!< DC (M5 extension)
+struct snapshot_t {
+    Mode mode{};         //!< Mode
+    uint8_t control{};   //!< CONTROL
+    uint32_t freq[2]{};  //!< Frequency of each bank (Hz)
+    uint16_t deg[2]{};   //!< Phase of each bank (degree)
+};
+
+/*!
+  @struct power_statistics_t
+  @brief Statistics of the idle power management
+ */
+struct power_statistics_t {
+    uint32_t sleeps{};        //!< Number of idle sleeps
+    uint32_t wakes{};         //!< Number of wakes by output commands
+    uint64_t sleeping_ms{};   //!< Total time in idle sleep (ms)
+    uint32_t last_wake_us{};  //!< Latency of the last wake (us)
+    uint32_t max_wake_us{};   //!< Maximum latency of wake (us)
+};
+
+/*!
+  @struct urgent_statistics_t
+  @brief Statistics of the urgent commands
+ */
+struct urgent_statistics_t {
+    uint32_t commands{};         //!< Number of CONTROL writes by urgent commands
+    uint32_t preempted{};        //!< Number of them written between the operations of another call
+    uint32_t failed{};           //!< Number of failed writes
+    uint32_t last_latency_us{};  //!< Time from the request to the end of the write (us)
+    uint32_t max_latency_us{};   //!< Maximum of last_latency_us
+};
+
+/*!
+  @enum Verify
+  @brief Readback verification mode
+ */
+enum class Verify : uint8_t {
+    Never,    //!< No readback
+    Always,   //!< Readback every write
+    Sampled,  //!< Readback 1 in N writes
+};
+
+/*!
+  @struct verify_statistics_t
+  @brief Statistics of readback verification
+ */
+struct verify_statistics_t {
+    uint32_t verified{};    //!< Number of readbacks
+    uint32_t mismatches{};  //!< Number of mismatches
+};
+
+/*!
+  @struct Op
+  @brief Operation for UnitDDS::writeBatch
+ */
+struct Op {
+    /*!
+      @enum Type
+      @brief Operation type
+     */
+    enum class Type : uint8_t {
+        Frequency,  //!< writeFrequency
+        Phase,      //!< writePhase
+        Mode,       //!< writeMode
+        Current,    //!< writeCurrent
+        Sleep,      //!< SLEEP1/SLEEP12 bits
+    };
+    Type type{};       //!< Operation type
+    bool select{};     //!< Bank / Frequency bank (Current) / MCLK (Sleep)
+    bool select2{};    //!< Phase bank (Current) / DAC (Sleep)
+    uint32_t value{};  //!< Frequency (Hz) / Phase (degree) / Mode
+
+    ///@name Factory
+    ///@{
+    static Op frequency(const bool select, const uint32_t freq)
+    {
+        return Op(Type::Frequency, select, false, freq);
+    }
+    static Op phase(const bool select, const uint16_t deg)
+    {
+        return Op(Type::Phase, select, false, deg);
+    }
+    static Op mode(const Mode m)
+    {
+        return Op(Type::Mode, false, false, static_cast<uint32_t>(m));
+    }
+    static Op current(const bool select_freq, const bool select_phase)
+    {
+        return Op(Type::Current, select_freq, select_phase, 0);
+    }
+    //! @note Both false means wake up from sleep
+    static Op sleep(const bool mclk, const bool DAC)
+    {
+        return Op(Type::Sleep, mclk, DAC, 0);
+    }
+    ///@}
+
+    Op() = default;
+    Op(const Type t, const bool s, const bool s2, const uint32_t v) : type(t), select(s), select2(s2), value(v)
+    {
+    }
+};
+
+/*!
+  @struct retry_statistics_t
+  @brief Statistics of retry and bus recovery
+ */
+struct retry_statistics_t {
+    uint32_t retries{};      //!< Number of retried attempts
+    uint32_t failures{};     //!< Number of transactions failed all attempts
+    uint32_t recoveries{};   //!< Number of successful recoveries
+    uint32_t max_latency{};  //!< Maximum latency of a transaction including retries and recovery (us)
 };
 
 }  // namespace dds
@@ -50,11 +192,13 @@ public:
       @brief Settings for begin
      */
     struct config_t {
+        bool check_description{true};    //!< Read and check the description on begin (e.g. once per bus in a fleet)
         bool start_output{true};         //!< Start output on begin if true
         dds::Mode mode{dds::Mode::Sin};  //!< Output mode if start output on begin
         bool select{};                   //!< Using bank if start output on begin
         uint32_t freq{10000};            //!< Frequency if start output on begin
         uint16_t deg{0};                 //!< Phase if start output on begin
+        bool hold_reset{false};          //!< Keep RESET after programming the output on begin (See also dds::Group)
     };
 
     explicit UnitDDS(const uint8_t addr = DEFAULT_ADDRESS) : Component(addr)
@@ -68,6 +212,7 @@ public:
     }
 
     virtual bool begin() override;
+    virtual void update(const bool force = false) override;
 
     ///@name Settings for begin
     ///@{
@@ -86,14 +231,130 @@ public:
     ///@name Properties
     ///@{
     //! @brief Gets written frequency 0 (Hz)
-    uint16_t frequency0() const
+    uint32_t frequency0() const
     {
-        return _freq[0];
+        return _snap[1].load(std::memory_order_relaxed);
     }
     //! @brief Gets written frequency 1 (Hz)
-    uint16_t frequency1() const
+    uint32_t frequency1() const
+    {
+        return _snap[2].load(std::memory_order_relaxed);
+    }
+    //! @brief Gets written FTW
+    inline uint32_t frequencyWord(const bool select) const
+    {
+        return _core.frequencyWord(select);
+    }
+    /*!
+      @brief Gets the cached CONTROL value
+      @note Valid after readControl or any write that touches CONTROL
+     */
+    uint8_t control() const
     {
-        return _freq[1];
+        return _snap[0].load(std::memory_order_relaxed) & 0xFF;
+    }
+    /*!
+      @brief Is the cached CONTROL value valid?
+      @note Invalid after a failed CONTROL write until readControl or the next write that touches CONTROL
+     */
+    inline bool controlValid() const
+    {
+        return _core.controlValid();
+    }
+    //! @brief Gets the frequency bank in use (cached CONTROL)
+    bool currentFrequencyBank() const
+    {
+        return control() & 0x40;
+    }
+    //! @brief Gets the phase bank in use (cached CONTROL)
+    bool currentPhaseBank() const
+    {
+        return control() & 0x20;
+    }
+    /*!
+      @brief Gets the consistent snapshot of the cached configuration
+      @note Lock-free, never blocks the writer
+     */
+    dds::snapshot_t snapshot() const;
+    ///@}
+
+    ///@name Idle power management
+    ///@{
+    /*!
+      @brief Sleep automatically when idle
+      @details update() puts the unit to sleep after idle_ms without output commands,
+      and the next output command wakes it transparently.
+      A command that writes CONTROL (current bank, mode, output) wakes in the same write,
+      a frequency/phase-only command adds one CONTROL write at its end.
+      A playing tone sequence is never idle
+      @note Output held without commands (a long key down, Dither without switches) counts as idle
+      @param idle_ms Idle time to sleep (ms), 0 to disable
+      @param mclk Sleep mclk
+      @param DAC Sleep DAC
+     */
+    void idleSleep(const uint32_t idle_ms, const bool mclk = true, const bool DAC = true);
+    //! @brief Gets the idle time to sleep (ms), 0 if disabled
+    inline uint32_t idleSleep() const
+    {
+        return _idle_ms;
+    }
+    //! @brief Is sleeping by the idle power management?
+    inline bool isIdleSleeping() const
+    {
+        return _idle_sleeping;
+    }
+    //! @brief Gets the power statistics
+    inline const dds::power_statistics_t& powerStatistics() const
+    {
+        return _power_stat;
+    }
+    //! @brief Reset the power statistics
+    inline void resetPowerStatistics()
+    {
+        _power_stat = dds::power_statistics_t{};
+    }
+    ///@}
+
+    ///@name Urgent commands
+    ///@{
+    /*!
+      @brief Write the CONTROL bits of the operation ahead of the other commands
+      @details Written at once if the bus is free. If another call is in progress (e.g. loading a table
+      with writeBatch), it is written after the operation in progress (each operation of writeBatch,
+      at the latest before that call returns), and the rest of that call keeps the bits.
+      Requests before the write are merged into a single CONTROL write
+      @param op Op::Type::Current or Op::Type::Sleep
+      @return True if written or requested, false if the operation is not urgent-capable or the write failed
+      @note Call from another task with threadSafe(true), or from a callback of the call in progress
+     */
+    bool writeUrgent(const dds::Op& op);
+    //! @brief Gets the urgent command statistics
+    inline const dds::urgent_statistics_t& urgentStatistics() const
+    {
+        return _urgent_stat;
+    }
+    //! @brief Reset the urgent command statistics
+    inline void resetUrgentStatistics()
+    {
+        _urgent_stat = dds::urgent_statistics_t{};
+    }
+    ///@}
+
+    ///@name Thread safety
+    ///@{
+    /*!
+      @brief Enable/Disable the bus lock
+      @details If enabled, each API call holds the lock while accessing the device
+      @warning Do not change while other threads are using this unit
+     */
+    inline void threadSafe(const bool enable)
+    {
+        _thread_safe = enable;
+    }
+    //! @brief Is the bus lock enabled?
+    inline bool threadSafe() const
+    {
+        return _thread_safe;
     }
     ///@}
 
@@ -109,11 +370,118 @@ public:
       @brief Write the mode
       @param mode Mode
       @return True if successful
+      @note MODE is read only if the cached value is invalid, a change of MODE by another master is not picked up
+      until readMode or resync
       @warning Frequency and phase settings are ignored for Mode::Sawtooth and Mode::DC
      */
     bool writeMode(const dds::Mode mode);
     ///@}
 
+    ///@name Control
+    ///@{
+    /*!
+      @brief Read the CONTROL and refresh the cached value
+      @param[out] ctrl CONTROL value
+      @return True if successful
+     */
+    bool readControl(uint8_t& ctrl);
+    /*!
+      @brief Write the mode and the whole CONTROL in a single burst
+      @param mode Mode
+      @param ctrl CONTROL value
+      @return True if successful
+      @note The frequencies cleared by the firmware in Sawtooth/DC are written back when leaving them
+     */
+    bool writeModeAndControl(const dds::Mode mode, const uint8_t ctrl);
+    ///@}
+
+    ///@name Retry and recovery
+    ///@{
+    //! @brief Gets the retry policy
+    inline const dds::retry_policy_t& retryPolicy() const
+    {
+        return _retry;
+    }
+    //! @brief Set the retry policy
+    inline void retryPolicy(const dds::retry_policy_t& policy)
+    {
+        _retry = policy;
+    }
+    //! @brief Gets the retry statistics
+    inline const dds::retry_statistics_t& retryStatistics() const
+    {
+        return _retry_stat;
+    }
+    //! @brief Reset the retry statistics
+    inline void resetRetryStatistics()
+    {
+        _retry_stat = dds::retry_statistics_t{};
+    }
+    /*!
+      @brief Worst-case latency of a single transaction under the current policy
+      @param transaction_us Worst-case time of one I2C transaction (us)
+      @return Latency including retries, recovery and resync (us)
+     */
+    uint32_t worstCaseLatency(const uint32_t transaction_us) const;
+    /*!
+      @brief Resynchronize the device with the shadow state
+      @details Reads CONTROL and MODE, then rewrites frequency and phase of both banks
+      (only phases in Sawtooth/DC, the frequencies are written back by writeMode)
+      @return True if successful
+     */
+    bool resync();
+    /*!
+      @brief Check the link at the current I2C clock
+      @details Each trial rewrites CONTROL from the shadow and reads back MODE, CONTROL and the description,
+      a single attempt per transaction without retry and recovery (4 transactions)
+      @param trials Number of trials
+      @param[out] errors Number of failed transactions and mismatches
+      @return True if probed, false if the shadow is not valid
+      @note Read the mode and CONTROL (readMode, readControl) at a reliable clock beforehand
+      @sa dds::ClockTuner
+     */
+    bool probeLink(const uint32_t trials, uint32_t& errors);
+    ///@}
+
+    ///@name Readback verification
+    ///@{
+    /*!
+      @brief Callback on mismatch
+      @param reg Register
+      @param expected Written value
+      @param actual Read value
+     */
+    using mismatch_callback_t = std::function<void(const uint8_t reg, const uint8_t expected, const uint8_t actual)>;
+    /*!
+      @brief Set the verification mode
+      @param mode Verification mode
+      @param interval Readback 1 in interval writes if Verify::Sampled
+      @note Only MODE and CONTROL are verified, the firmware has no readback of frequency and phase
+      @note The write returns false on mismatch
+     */
+    void verification(const dds::Verify mode, const uint32_t interval = 1);
+    //! @brief Gets the verification mode
+    inline dds::Verify verification() const
+    {
+        return _verify;
+    }
+    //! @brief Set the callback on mismatch
+    inline void setMismatchCallback(mismatch_callback_t cb)
+    {
+        _mismatch_cb = cb;
+    }
+    //! @brief Gets the verification statistics
+    inline const dds::verify_statistics_t& verifyStatistics() const
+    {
+        return _verify_stat;
+    }
+    //! @brief Reset the verification statistics
+    inline void resetVerifyStatistics()
+    {
+        _verify_stat = dds::verify_statistics_t{};
+    }
+    ///@}
+
     ///@name Settings
     ///@{
     /*!
@@ -144,6 +512,23 @@ public:
     {
         return writeFrequency(true, freq);
     }
+    /*!
+      @brief Write the raw frequency tuning word
+      @param select Target bank 0 if false, bank 1 if true
+      @param ftw FTW 0 - dds::frequency_to_ftw(1Mhz)
+      @return True if successful
+      @note For precomputed tables such as dds::Chirp, no conversion at write time
+      @warning Frequency and phase settings are ignored for Mode::Sawtooth and Mode::DC
+     */
+    bool writeFrequencyWord(const bool select, const uint32_t ftw);
+    /*!
+      @brief Write the precomputed frequency frame as is
+      @param frame Frame encoded by dds::codec::encode_ftw, the bank is selected by the frame
+      @return True if successful
+      @note For streaming tables such as dds::FM, no encoding at write time
+      @warning Frequency and phase settings are ignored for Mode::Sawtooth and Mode::DC
+     */
+    bool writeFrequencyFrame(const uint8_t frame[4]);
     /*!
       @brief Write the phase
       @param select Target bank 0 if false, bank 1 if true
@@ -219,6 +604,30 @@ public:
       @warning Frequency and phase settings are ignored for Mode::Sawtooth and Mode::DC
      */
     bool writeOutput(const dds::Mode mode, const bool select, const uint32_t freq, const uint16_t deg);
+    /*!
+      @brief Write many operations in the fewest bursts
+      @details Adjacent operations are merged
+      - Frequency and phase into a 6-byte burst
+      - Mode, current and sleep into a single CONTROL or a MODE+CONTROL burst
+      @param ops Operations
+      @param count Number of operations
+      @param[out] results Result of each operation (nullptr if not needed)
+      @return Number of successful operations
+     */
+    size_t writeBatch(const dds::Op* ops, const size_t count, bool* results = nullptr);
+    //! @brief Write many operations in the fewest bursts
+    template <size_t N>
+    inline size_t writeBatch(const dds::Op (&ops)[N], bool* results = nullptr)
+    {
+        return writeBatch(ops, N, results);
+    }
+#if defined(M5_UNIT_DDS_ENABLE_SPAN)
+    //! @brief Write many operations in the fewest bursts
+    inline size_t writeBatch(std::span<const dds::Op> ops, std::span<bool> results = {})
+    {
+        return writeBatch(ops.data(), ops.size(), results.size() >= ops.size() ? results.data() : nullptr);
+    }
+#endif
     /*!
       @brief Sleep
       @param mclk Sleep mclk (Keep output current value)
@@ -238,6 +647,36 @@ public:
       @note Fixes DAC output to mid-scale
      */
     bool reset();
+    /*!
+      @brief Key the output on/off
+      @param on Output if true, DAC sleep if false
+      @return True if successful
+      @note Only SLEEP12 is rewritten by a single CONTROL write from the shadow, without the delay of wakeup()
+      @sa dds::Keyer
+     */
+    bool key(const bool on);
+    /*!
+      @brief Hold or release the RESET
+      @param hold Hold if true, release if false
+      @return True if successful
+      @note SLEEP bits are cleared in the same single CONTROL write, so the output starts on release
+      @sa dds::Group
+     */
+    bool writeReset(const bool hold);
+    /*!
+      @brief Program the whole output without reading
+      @details MODE+CONTROL with RESET, then frequency and phase in a single burst, then RESET release
+      @param mode Output mode
+      @param select Bank for frequency and phase
+      @param freq Frequency(Hz) 0 - 1Mhz
+      @param deg Phase (degree)
+      @param hold Keep RESET if true (2 transactions), release it if false (3 transactions)
+      @return True if successful
+      @note SLEEP bits and the upper bits of MODE are cleared
+      @note The other bank is written back if leaving Sawtooth/DC (1 more transaction)
+     */
+    bool program(const dds::Mode mode, const bool select, const uint32_t freq, const uint16_t deg,
+                 const bool hold = false);
     ///@}
 
     /*!
@@ -248,27 +687,191 @@ public:
      */
     bool readDescription(char str[7]);
 
+    ///@name Tone player
+    ///@{
+    /*!
+      @brief Play the tone frames
+      @details Each frame is written to the inactive bank in advance, and switched by a single CONTROL write.
+      Rest frames sleep the DAC (same as sleep(false, true)), and the next tone wakes it with the same write
+      @param tones Tone frames (must be alive while playing)
+      @param count Number of frames
+      @param loop Repeat if true
+      @return True if successful
+      @note Played by update() without blocking, the output of the last frame remains after the end
+     */
+    bool playTones(const dds::Tone* tones, const size_t count, const bool loop = false);
+    //! @brief Play the tone frames
+    template <size_t N>
+    inline bool playTones(const dds::Tone (&tones)[N], const bool loop = false)
+    {
+        return playTones(tones, N, loop);
+    }
+    //! @brief Stop playing
+    inline void stopTones()
+    {
+        _tones = nullptr;
+    }
+    //! @brief Is playing the tone frames?
+    inline bool isPlayingTones() const
+    {
+        return _tones != nullptr;
+    }
+    ///@}
+
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+    ///@name Coroutine (C++20)
+    ///@{
+    /*!
+      @brief Run the sequence
+      @param seq Sequence
+      @note The sequence is resumed cooperatively by update()
+     */
+    void run(dds::Sequence&& seq);
+    //! @brief Gets the number of running sequences
+    inline size_t runningSequences() const
+    {
+        return _sequences.size();
+    }
+    //! @brief Stop all running sequences
+    inline void stopSequences()
+    {
+        _sequences.clear();
+    }
+    //! @brief Awaitable writeMode
+    inline auto writeModeAsync(const dds::Mode mode)
+    {
+        return dds::Invoke{[=, this]() { return writeMode(mode); }};
+    }
+    //! @brief Awaitable writeFrequency
+    inline auto writeFrequencyAsync(const bool select, const uint32_t freq)
+    {
+        return dds::Invoke{[=, this]() { return writeFrequency(select, freq); }};
+    }
+    //! @brief Awaitable writePhase
+    inline auto writePhaseAsync(const bool select, const uint16_t deg)
+    {
+        return dds::Invoke{[=, this]() { return writePhase(select, deg); }};
+    }
+    //! @brief Awaitable writeFrequencyAndPhase
+    inline auto writeFrequencyAndPhaseAsync(const bool select_freq, const uint32_t freq, const bool select_phase,
+                                            const uint16_t deg)
+    {
+        return dds::Invoke{
+            [=, this]() { return writeFrequencyAndPhase(select_freq, freq, select_phase, deg); }};
+    }
+    //! @brief Awaitable writeCurrent
+    inline auto writeCurrentAsync(const bool select_freq, const bool select_phase)
+    {
+        return dds::Invoke{[=, this]() { return writeCurrent(select_freq, select_phase); }};
+    }
+    //! @brief Awaitable writeOutput
+    inline auto writeOutputAsync(const dds::Mode mode, const bool select, const uint32_t freq, const uint16_t deg)
+    {
+        return dds::Invoke{[=, this]() { return writeOutput(mode, select, freq, deg); }};
+    }
+    //! @brief Awaitable sleep
+    inline auto sleepAsync(const bool mclk = true, const bool DAC = true)
+    {
+        return dds::Invoke{[=, this]() { return sleep(mclk, DAC); }};
+    }
+    //! @brief Awaitable wakeup
+    inline auto wakeupAsync()
+    {
+        return dds::Invoke{[this]() { return wakeup(); }};
+    }
+    ///@}
+#endif
+
 protected:
-    bool read_control(uint8_t& ctrl);
-    bool write_register8(const uint8_t reg, const uint8_t v);
+    // Holds the bus lock and writes the urgent commands between the API calls
+    // Wakes from idle sleep if needed and publishes the snapshot on leaving the outermost API call
+    class Guard {
+    public:
+        explicit Guard(UnitDDS& u);
+        ~Guard();
+        Guard(const Guard&)            = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        UnitDDS& _u;
+    };
+    // Bus of the driver core, with retry, verification, urgent commands and idle wake of this unit
+    class ComponentBus {
+    public:
+        explicit ComponentBus(UnitDDS* u) : _u(u)
+        {
+        }
+        bool write(const uint8_t reg, const uint8_t* buf, const size_t len);
+        bool read(const uint8_t reg, uint8_t* buf, const size_t len);
+        uint8_t controlToWrite(const uint8_t ctrl);
+
+    private:
+        UnitDDS* _u{};
+    };
+
+    void publish();
+    void touch();
+    void woken();
+    void end_idle_sleep();
+
+    // Single attempt of a transaction
+    M5_UNIT_DDS_TRANSPORT bool read_transaction(const uint8_t reg, uint8_t* buf, const size_t len)
+    {
+        return readRegister(reg, buf, len, 0);
+    }
+    M5_UNIT_DDS_TRANSPORT bool write_transaction(const uint8_t reg, const uint8_t* buf, const size_t len)
+    {
+        return writeRegister(reg, buf, len);
+    }
+
+    bool read_register(const uint8_t reg, uint8_t* buf, const size_t len);
+    bool write_register(const uint8_t reg, const uint8_t* buf, const size_t len);
+    template <typename F>
+    bool with_retry(F func);
+    bool write_bus(const uint8_t reg, const uint8_t* buf, const size_t len);
+    uint8_t control_to_write(const uint8_t value) const;
+    bool verify_register8(const uint8_t reg, const uint8_t v);
+    bool prepare_tone();
+    bool start_tone();
+    bool service_urgent(const bool preempt);
+
+    dds::BasicUnitDDS<ComponentBus> _core{this};  // Shadow of MODE, CONTROL and both banks
 
 private:
     config_t _cfg{};
-    dds::Mode _mode{};
-    uint16_t _freq[2]{};
-};
+    dds::retry_policy_t _retry{};
+    dds::retry_statistics_t _retry_stat{};
+    bool _recovering{};
+    dds::Verify _verify{dds::Verify::Never};
+    uint32_t _verify_interval{1}, _verify_count{};
+    dds::verify_statistics_t _verify_stat{};
+    mismatch_callback_t _mismatch_cb{};
 
-namespace dds {
-namespace command {
-///@cond
-constexpr uint8_t READ_DESCRIPTION_REG{0x10};
-constexpr uint8_t MODE_REG{0x20};
-constexpr uint8_t CONTROL_REG{0x21};
-constexpr uint8_t FREQUENCY_REG{0x30};
-constexpr uint8_t PHASE_REG{0x34};
-///@endcond
-}  // namespace command
-}  // namespace dds
+    std::recursive_mutex _bus_mutex{};
+    std::atomic<uint32_t> _seq{};
+    std::atomic<uint32_t> _snap[4]{};  // mode|control, freq0, freq1, deg0|deg1
+    uint32_t _depth{};
+    bool _thread_safe{};
+
+    uint32_t _idle_ms{};
+    uint8_t _idle_bits{};  // SLEEP bits set by the idle power management
+    bool _idle_sleeping{}, _touched{};
+    unsigned long _last_activity{}, _sleep_at{}, _touch_us{};
+    dds::power_statistics_t _power_stat{};
+
+    std::atomic<uint32_t> _urgent{};     // Requested mask << 8 | bits
+    std::atomic<uint32_t> _urgent_at{};  // Time of the first request (us)
+    uint8_t _urgent_mask{}, _urgent_bits{};  // Kept by the rest of the call in progress
+    dds::urgent_statistics_t _urgent_stat{};
+
+    const dds::Tone* _tones{};
+    size_t _tone_count{}, _tone_index{};
+    unsigned long _tone_start{}, _tone_ms{};  // Scheduled start and duration of the current frame
+    bool _tone_loop{}, _tone_prepared{};
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+    std::vector<dds::Sequence> _sequences{};
+#endif
+};
 
 }  // namespace unit
 }  // namespace m5
@@ -13,11 +13,30 @@
 #include <googletest/test_template.hpp>
 #include <googletest/test_helper.hpp>
 #include <unit/unit_DDS.hpp>
+#include <unit/dds_scheduler.hpp>
+#include <unit/dds_chirp.hpp>
+#include <unit/dds_pair.hpp>
+#include <unit/dds_fm.hpp>
+#include <unit/dds_keyer.hpp>
+#include <unit/dds_dither.hpp>
+#include <unit/dds_group.hpp>
+#include <unit/dds_queue.hpp>
+#include <unit/dds_clock.hpp>
+#include <unit/dds_simulator.hpp>
+#include "../../fuzz/dds_fuzz.hpp"
 #include <chrono>
 #include <thread>
 #include <iostream>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+// HookedUnitDDS and SimulatedUnitDDS override the transactions (See also [test_fw] of platformio.ini)
+#if !defined(M5_UNIT_DDS_TEST_TRANSPORT)
+#error "M5_UNIT_DDS_TEST_TRANSPORT is required"
+#endif
 
 using namespace m5::unit::googletest;
 using namespace m5::unit;
@@ -27,11 +46,27 @@ using m5::unit::types::elapsed_time_t;
 
 const ::testing::Environment* global_fixture = ::testing::AddGlobalTestEnvironment(new GlobalFixture<400000U>());
 
+// UnitDDS with a hook into the call in progress
+class HookedUnitDDS : public UnitDDS {
+public:
+    std::function<void()> on_write{};  // Called after each write transaction
+
+protected:
+    virtual bool write_transaction(const uint8_t reg, const uint8_t* buf, const size_t len) override
+    {
+        const bool r = UnitDDS::write_transaction(reg, buf, len);
+        if (on_write) {
+            on_write();
+        }
+        return r;
+    }
+};
+
 class TestDDS : public ComponentTestBase<UnitDDS, bool> {
 protected:
     virtual UnitDDS* get_instance() override
     {
-        auto ptr = new m5::unit::UnitDDS();
+        auto ptr = new HookedUnitDDS();
         return ptr;
     }
     virtual bool is_using_hal() const override
@@ -93,6 +128,30 @@ TEST_P(TestDDS, Mode)
     }
 }
 
+TEST_P(TestDDS, ModeRestore)
+{
+    SCOPED_TRACE(ustr);
+
+    // Odd FTW not representable in integer Hz
+    EXPECT_TRUE(unit->writeMode(Mode::Sin));
+    EXPECT_TRUE(unit->writeFrequencyWord(false, 123457));
+    EXPECT_TRUE(unit->writeFrequencyAndPhase(true, 5000, true, 90));
+
+    const auto before = unit->snapshot();
+    for (auto&& mode : {Mode::Sawtooth, Mode::Triangle, Mode::DC, Mode::Square, Mode::Sin}) {
+        EXPECT_TRUE(unit->writeMode(mode));
+        Mode m{};
+        EXPECT_TRUE(unit->readMode(m));
+        EXPECT_EQ(m, mode);
+    }
+    // The firmware has no readback of FTW, the registers are checked by SimulatedDDS.ModeRestore
+    const auto after = unit->snapshot();
+    EXPECT_EQ(after.freq[0], before.freq[0]);
+    EXPECT_EQ(after.freq[1], before.freq[1]);
+    EXPECT_EQ(after.deg[1], 90U);
+    EXPECT_TRUE(unit->resync());
+}
+
 TEST_P(TestDDS, Settings)
 {
     SCOPED_TRACE(ustr);
@@ -222,3 +281,1297 @@ TEST_P(TestDDS, Sleep)
     c = read_control(unit.get());
     EXPECT_EQ(0, c & 0x1C);
 }
+
+TEST_P(TestDDS, Scheduler)
+{
+    SCOPED_TRACE(ustr);
+
+    // Virtual clock
+    uint64_t vclock{};
+    Scheduler sch(*unit, 2, [&vclock]() { return vclock; });
+    auto cfg    = sch.config();
+    cfg.lead_us = 1000;
+    cfg.late_us = 100;
+    sch.config(cfg);
+
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+
+    EXPECT_TRUE(sch.schedule(10000, 2000));
+    EXPECT_TRUE(sch.schedule(5000, 3000, 90));
+    EXPECT_FALSE(sch.schedule(20000, 4000));  // full
+    EXPECT_EQ(sch.nextDeadline(), 5000U);
+
+    vclock = 3999;
+    EXPECT_EQ(sch.update(), 0U);
+    EXPECT_EQ(unit->frequency1(), 0U);
+
+    // Prepared inactive bank, not flipped yet
+    vclock = 4000;
+    EXPECT_EQ(sch.update(), 0U);
+    EXPECT_EQ(unit->frequency1(), 3000U);
+    EXPECT_EQ(read_control(unit.get()) & 0x60, 0x00);
+
+    vclock = 5000;
+    EXPECT_EQ(sch.update(), 1U);
+    EXPECT_EQ(read_control(unit.get()) & 0x60, 0x60);
+
+    // Late: prepare and flip at once
+    vclock = 10250;
+    EXPECT_EQ(sch.update(), 1U);
+    EXPECT_EQ(unit->frequency0(), 2000U);
+    EXPECT_EQ(read_control(unit.get()) & 0x60, 0x00);
+    EXPECT_EQ(sch.pending(), 0U);
+
+    auto& stat = sch.statistics();
+    EXPECT_EQ(stat.executed, 2U);
+    EXPECT_EQ(stat.late, 1U);
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_EQ(stat.max_lateness, 250U);
+    EXPECT_EQ(stat.average(), 125U);
+}
+
+#if defined(M5_UNIT_DDS_ENABLE_COROUTINE)
+namespace {
+Sequence sweep(UnitDDS& u, uint32_t& steps)
+{
+    for (auto&& f : valid_freq_table) {
+        EXPECT_TRUE(co_await u.writeFrequencyAsync(false, f));
+        ++steps;
+        co_await after(10);
+    }
+    EXPECT_TRUE(co_await u.writeCurrentAsync(true, true));
+}
+}  // namespace
+
+TEST_P(TestDDS, Coroutine)
+{
+    SCOPED_TRACE(ustr);
+
+    uint32_t steps{};
+    unit->run(sweep(*unit, steps));
+    EXPECT_EQ(unit->runningSequences(), 1U);
+    EXPECT_EQ(steps, 0U);  // Suspended until update
+
+    auto timeout_at = m5::utility::millis() + 1000;
+    while (unit->runningSequences() && m5::utility::millis() <= timeout_at) {
+        unit->update();
+        m5::utility::delay(1);
+    }
+    EXPECT_EQ(unit->runningSequences(), 0U);
+    EXPECT_EQ(steps, m5::stl::size(valid_freq_table));
+    EXPECT_EQ(read_control(unit.get()) & 0x60, 0x60);
+}
+#endif
+
+TEST_P(TestDDS, Retry)
+{
+    SCOPED_TRACE(ustr);
+
+    retry_policy_t policy{};
+    policy.max_attempts = 3;
+    policy.backoff_us   = 100;
+    policy.deadline_us  = 1000;
+    unit->retryPolicy(policy);
+    // 200 + (100 + 200) + (200 + 200)
+    EXPECT_EQ(unit->worstCaseLatency(200), 900U);
+
+    policy.deadline_us = 500;
+    unit->retryPolicy(policy);
+    EXPECT_EQ(unit->worstCaseLatency(200), 700U);
+
+    uint32_t recovered{};
+    policy.recover = [&recovered]() {
+        ++recovered;
+        return true;
+    };
+    policy.recover_us = 1000;
+    unit->retryPolicy(policy);
+    // + recover + (resync + retried) transactions
+    EXPECT_EQ(unit->worstCaseLatency(200), 700U + 1000U + 5 * 200U);
+
+    // Shadow keeps full range of frequency
+    EXPECT_TRUE(unit->writeFrequencyAndPhase(false, MAXIMUM_FREQ, false, 90));
+    EXPECT_TRUE(unit->writeFrequencyAndPhase(true, MAXIMUM_FREQ / 2, true, 180));
+    EXPECT_EQ(unit->frequency0(), MAXIMUM_FREQ);
+    EXPECT_EQ(unit->frequency1(), MAXIMUM_FREQ / 2);
+    EXPECT_TRUE(unit->resync());
+    EXPECT_EQ(unit->frequency0(), MAXIMUM_FREQ);
+    EXPECT_EQ(unit->frequency1(), MAXIMUM_FREQ / 2);
+    EXPECT_EQ(recovered, 0U);
+    EXPECT_EQ(unit->retryStatistics().failures, 0U);
+}
+
+TEST_P(TestDDS, Verification)
+{
+    SCOPED_TRACE(ustr);
+
+    uint32_t called{};
+    unit->setMismatchCallback([&called](const uint8_t, const uint8_t, const uint8_t) { ++called; });
+
+    unit->verification(Verify::Always);
+    EXPECT_EQ(unit->verification(), Verify::Always);
+    for (auto&& mode : mode_table) {
+        EXPECT_TRUE(unit->writeMode(mode));  // MODE and CONTROL
+    }
+    EXPECT_EQ(unit->verifyStatistics().verified, m5::stl::size(mode_table) * 2);
+
+    unit->resetVerifyStatistics();
+    unit->verification(Verify::Sampled, 4);
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(unit->writeCurrent(i & 1, i & 1));
+    }
+    EXPECT_EQ(unit->verifyStatistics().verified, 2U);
+
+    unit->resetVerifyStatistics();
+    unit->verification(Verify::Never);
+    EXPECT_TRUE(unit->sleep());
+    EXPECT_TRUE(unit->wakeup());
+    EXPECT_EQ(unit->verifyStatistics().verified, 0U);
+
+    EXPECT_EQ(unit->verifyStatistics().mismatches, 0U);
+    EXPECT_EQ(called, 0U);
+}
+
+TEST_P(TestDDS, Batch)
+{
+    SCOPED_TRACE(ustr);
+
+    // Merged: [0,1] [2,3] [5,6,7], Invalid: [4]
+    const Op ops[] = {
+        Op::frequency(false, 2000),
+        Op::phase(false, 90),
+        Op::phase(true, 180),
+        Op::frequency(true, 3000),
+        Op::frequency(true, MAXIMUM_FREQ + 1),
+        Op::mode(Mode::Triangle),
+        Op::current(true, true),
+        Op::sleep(true, false),
+        Op::frequency(false, 5000),
+    };
+    bool results[m5::stl::size(ops)]{};
+    EXPECT_EQ(unit->writeBatch(ops, results), m5::stl::size(ops) - 1);
+    for (size_t i = 0; i < m5::stl::size(ops); ++i) {
+        EXPECT_EQ(results[i], i != 4) << i;
+    }
+    EXPECT_EQ(unit->frequency0(), 5000U);
+    EXPECT_EQ(unit->frequency1(), 3000U);
+
+    Mode m{};
+    EXPECT_TRUE(unit->readMode(m));
+    EXPECT_EQ(m, Mode::Triangle);
+    uint8_t c = read_control(unit.get());
+    EXPECT_EQ(c & 0x78, 0x70) << c;
+
+    const Op wake[] = {Op::sleep(false, false), Op::current(false, false)};
+    EXPECT_EQ(unit->writeBatch(wake), 2U);
+    c = read_control(unit.get());
+    EXPECT_EQ(c & 0x78, 0x00) << c;
+
+    // Modes other than Sin - DC are rejected, the rest of the run is written
+    const Op modes[] = {
+        Op::mode(Mode::Reserved),
+        Op::mode(Mode::Square),
+        Op(Op::Type::Mode, false, false, 7),
+        Op::current(true, false),
+    };
+    bool mresults[m5::stl::size(modes)]{};
+    EXPECT_EQ(unit->writeBatch(modes, mresults), 2U);
+    EXPECT_FALSE(mresults[0]);
+    EXPECT_TRUE(mresults[1]);
+    EXPECT_FALSE(mresults[2]);
+    EXPECT_TRUE(mresults[3]);
+    EXPECT_TRUE(unit->readMode(m));
+    EXPECT_EQ(m, Mode::Square);
+    c = read_control(unit.get());
+    EXPECT_EQ(c & 0x60, 0x40) << c;
+
+    EXPECT_EQ(unit->writeBatch(nullptr, 3), 0U);
+}
+
+TEST_P(TestDDS, ThreadSafe)
+{
+    SCOPED_TRACE(ustr);
+
+    unit->threadSafe(true);
+    EXPECT_TRUE(unit->threadSafe());
+
+    constexpr uint32_t loops{200};
+    std::atomic<bool> done{};
+    std::atomic<uint32_t> inconsistent{}, reads{}, failed{};
+
+    for (auto&& b : bank_table) {
+        EXPECT_TRUE(unit->writeFrequencyAndPhase(b, 0, b, 0));
+    }
+
+    // Writers: frequency and phase of a bank are always written together
+    std::vector<std::thread> writers;
+    for (auto&& b : bank_table) {
+        writers.emplace_back([&, b]() {
+            for (uint32_t f = 1; f <= loops; ++f) {
+                if (!unit->writeFrequencyAndPhase(b, f * 100, b, f % 360)) {
+                    ++failed;
+                }
+                if (!unit->writeCurrent(b, b)) {
+                    ++failed;
+                }
+            }
+        });
+    }
+    // Readers never block the writers
+    std::vector<std::thread> readers;
+    for (uint32_t i = 0; i < 3; ++i) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                auto ss = unit->snapshot();
+                for (uint32_t b = 0; b < 2; ++b) {
+                    if (ss.freq[b] && ss.deg[b] != (ss.freq[b] / 100) % 360) {
+                        ++inconsistent;
+                    }
+                }
+                ++reads;
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (auto&& th : writers) {
+        th.join();
+    }
+    done = true;
+    for (auto&& th : readers) {
+        th.join();
+    }
+
+    EXPECT_EQ(failed.load(), 0U);
+    EXPECT_EQ(inconsistent.load(), 0U);
+    EXPECT_GT(reads.load(), 0U);
+    EXPECT_EQ(unit->frequency0(), loops * 100);
+    EXPECT_EQ(unit->frequency1(), loops * 100);
+    auto ss = unit->snapshot();
+    EXPECT_EQ(ss.control, read_control(unit.get()) & 0x7F);
+
+    unit->threadSafe(false);
+}
+
+TEST_P(TestDDS, UrgentCommand)
+{
+    SCOPED_TRACE(ustr);
+
+    unit->resetUrgentStatistics();
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+
+    EXPECT_FALSE(unit->writeUrgent(Op::frequency(false, 1000)));
+    EXPECT_FALSE(unit->writeUrgent(Op::mode(Mode::Sin)));
+
+    // Bus is free, written at once
+    EXPECT_TRUE(unit->writeUrgent(Op::current(true, true)));
+    EXPECT_EQ(read_control(unit.get()) & 0x60, 0x60);
+    auto& stat = unit->urgentStatistics();
+    EXPECT_EQ(stat.commands, 1U);
+    EXPECT_EQ(stat.preempted, 0U);
+
+    // Between the operations of the bulk load
+    auto hooked = static_cast<HookedUnitDDS*>(unit.get());
+    unit->threadSafe(true);
+    std::vector<Op> ops;
+    for (uint32_t i = 0; i < 200; ++i) {
+        ops.push_back(Op::frequency(i & 1, 1000 + i));
+    }
+    ops.push_back(Op::current(false, false));  // Keeps the urgent bits
+    std::promise<void> loading, requested;
+    auto requested_future = requested.get_future();
+    uint32_t writes{};
+    // The bulk load waits in its 10th write until the urgent command is requested
+    hooked->on_write = [&]() {
+        if (++writes == 10) {
+            loading.set_value();
+            requested_future.wait();
+        }
+    };
+    size_t succeeded{};
+    std::thread bulk([&]() { succeeded = unit->writeBatch(ops.data(), ops.size()); });
+    loading.get_future().wait();
+    EXPECT_TRUE(unit->writeUrgent(Op::sleep(false, true)));
+    requested.set_value();
+    bulk.join();
+    hooked->on_write = nullptr;
+    unit->threadSafe(false);
+
+    EXPECT_EQ(succeeded, ops.size());
+    EXPECT_EQ(stat.commands, 2U);
+    EXPECT_EQ(stat.preempted, 1U);
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_GE(stat.max_latency_us, stat.last_latency_us);
+    M5_LOGI("Urgent latency while bulk loading: %u us", stat.last_latency_us);
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x08);
+
+    // Not kept by the next call
+    EXPECT_TRUE(unit->wakeup());
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x00);
+
+    // Requested from a callback of a single operation, written before it returns
+    bool requested_once{};
+    hooked->on_write = [&]() {
+        if (!requested_once) {
+            requested_once = true;
+            EXPECT_TRUE(unit->writeUrgent(Op::sleep(false, true)));
+        }
+    };
+    EXPECT_TRUE(unit->writeFrequency(false, 2000));
+    hooked->on_write = nullptr;
+    EXPECT_EQ(stat.commands, 3U);
+    EXPECT_EQ(stat.preempted, 1U);
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x08);
+    EXPECT_TRUE(unit->wakeup());
+
+    // Same from a callback of a CONTROL write with threadSafe, this task already holds the recursive lock
+    unit->threadSafe(true);
+    requested_once = false;
+    hooked->on_write = [&]() {
+        if (!requested_once) {
+            requested_once = true;
+            EXPECT_TRUE(unit->writeUrgent(Op::sleep(false, true)));
+        }
+    };
+    EXPECT_TRUE(unit->writeCurrent(true, true));
+    hooked->on_write = nullptr;
+    unit->threadSafe(false);
+    EXPECT_EQ(stat.commands, 4U);
+    EXPECT_EQ(read_control(unit.get()) & 0x78, 0x68);
+    EXPECT_EQ(unit->control(), read_control(unit.get()) & 0x7F);  // The shadow follows the urgent write
+    EXPECT_TRUE(unit->wakeup());
+}
+
+TEST_P(TestDDS, IdleSleep)
+{
+    SCOPED_TRACE(ustr);
+
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+    EXPECT_TRUE(unit->wakeup());
+
+    unit->idleSleep(50, false, true);
+    EXPECT_EQ(unit->idleSleep(), 50U);
+    unit->update();
+    EXPECT_FALSE(unit->isIdleSleeping());
+
+    m5::utility::delay(60);
+    unit->update();
+    EXPECT_TRUE(unit->isIdleSleeping());
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x08);
+
+    // Woken by the bank flip itself
+    EXPECT_TRUE(unit->writeCurrent(true, true));
+    EXPECT_FALSE(unit->isIdleSleeping());
+    EXPECT_EQ(read_control(unit.get()) & 0x78, 0x60);
+
+    // Woken after the frequency write
+    m5::utility::delay(60);
+    unit->update();
+    EXPECT_TRUE(unit->isIdleSleeping());
+    EXPECT_TRUE(unit->writeFrequency(true, 2000));
+    EXPECT_FALSE(unit->isIdleSleeping());
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x00);
+
+    // Not woken if sleeping by the user
+    EXPECT_TRUE(unit->sleep(true, true));
+    m5::utility::delay(60);
+    unit->update();
+    EXPECT_FALSE(unit->isIdleSleeping());
+    EXPECT_TRUE(unit->wakeup());
+
+    auto& stat = unit->powerStatistics();
+    EXPECT_EQ(stat.sleeps, 2U);
+    EXPECT_EQ(stat.wakes, 2U);
+    EXPECT_GE(stat.max_wake_us, stat.last_wake_us);
+
+    unit->idleSleep(0);
+    EXPECT_EQ(unit->idleSleep(), 0U);
+}
+
+TEST_P(TestDDS, Chirp)
+{
+    SCOPED_TRACE(ustr);
+
+    // Table
+    uint32_t table[512]{};
+    EXPECT_FALSE(Chirp::generate(table, 1, 1000, 2000));
+    EXPECT_FALSE(Chirp::generate(table, 16, 1000, MAXIMUM_FREQ + 1));
+
+    EXPECT_TRUE(Chirp::generate(table, 11, 1000, 2000, Chirp::Type::Linear));
+    for (uint32_t i = 0; i < 11; ++i) {
+        EXPECT_EQ(ftw_to_frequency(table[i]), 1000 + i * 100) << i;
+    }
+    EXPECT_TRUE(Chirp::generate(table, 11, 100, 100000, Chirp::Type::Exponential));
+    EXPECT_EQ(table[0], frequency_to_ftw(100));
+    EXPECT_EQ(table[10], frequency_to_ftw(100000));
+    EXPECT_NEAR(ftw_to_frequency(table[5]), 3162, 3);  // Geometric mean
+    for (uint32_t i = 1; i < 11; ++i) {
+        EXPECT_GT(table[i], table[i - 1]) << i;
+    }
+
+    // Play
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+    Chirp chirp(*unit);
+    EXPECT_EQ(chirp.stepsFor(100, 512), 0U);
+    EXPECT_GT(chirp.measure(), 0U);
+    EXPECT_EQ(read_control(unit.get()) & 0x40, unit->control() & 0x40);
+
+    EXPECT_EQ(chirp.prepare(table, m5::stl::size(table), 1000, 20000, UINT32_MAX / 1000U + 1), 0U);  // Over 32-bit us
+    auto steps = chirp.prepare(table, m5::stl::size(table), 1000, 20000, 200, Chirp::Type::Exponential);
+    EXPECT_GE(steps, 2U);
+    EXPECT_LE(steps, m5::stl::size(table));
+    EXPECT_TRUE(chirp.play());
+
+    auto& stat = chirp.statistics();
+    EXPECT_EQ(stat.steps, steps);
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_GE(stat.duration_us, 200 * 1000U);
+    EXPECT_LT(stat.duration_us, 200 * 1000U + chirp.stepTime() * 2);
+    auto bank = unit->currentFrequencyBank();
+    EXPECT_EQ(bank ? unit->frequency1() : unit->frequency0(), 20000U);
+}
+
+TEST_P(TestDDS, Tone)
+{
+    SCOPED_TRACE(ustr);
+
+    static_assert(midi_to_ftw(69) == frequency_to_ftw(440), "A4");
+    static_assert(note(81, 100).ftw() == frequency_to_ftw(880), "A5");
+    static_assert(rest(100).isRest(), "Rest");
+
+    constexpr Tone melody[] = {
+        note(69, 50),
+        rest(30),
+        tone(2000, 50),
+    };
+
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+    EXPECT_FALSE(unit->playTones(nullptr, 0));
+    const Tone invalid[] = {tone(MAXIMUM_FREQ + 1, 10)};
+    EXPECT_FALSE(unit->playTones(invalid));
+    // Not wrapped to a valid FTW (20MHz would be 0Hz)
+    const Tone wrapped[] = {tone(20000000, 10)};
+    EXPECT_FALSE(unit->playTones(wrapped));
+
+    EXPECT_TRUE(unit->playTones(melody));
+    EXPECT_TRUE(unit->isPlayingTones());
+    EXPECT_EQ(read_control(unit.get()) & 0x48, 0x40);
+    EXPECT_EQ(unit->frequency1(), 440U);
+
+    bool rested{};
+    auto timeout_at = m5::utility::millis() + 1000;
+    while (unit->isPlayingTones() && m5::utility::millis() < timeout_at) {
+        unit->update();
+        rested |= (unit->control() & 0x08) != 0;
+        m5::utility::delay(1);
+    }
+    EXPECT_FALSE(unit->isPlayingTones());
+    EXPECT_TRUE(rested);
+    // Woken by the last tone
+    EXPECT_EQ(read_control(unit.get()) & 0x08, 0x00);
+    auto bank = unit->currentFrequencyBank();
+    EXPECT_EQ(bank ? unit->frequency1() : unit->frequency0(), 2000U);
+
+    // Loop and stop
+    EXPECT_TRUE(unit->playTones(melody, true));
+    auto start = m5::utility::millis();
+    while (m5::utility::millis() - start < 300) {
+        unit->update();
+        m5::utility::delay(1);
+    }
+    EXPECT_TRUE(unit->isPlayingTones());
+    unit->stopTones();
+    EXPECT_FALSE(unit->isPlayingTones());
+    EXPECT_TRUE(unit->wakeup());
+}
+
+TEST_P(TestDDS, Pair)
+{
+    SCOPED_TRACE(ustr);
+
+    constexpr char keys[]     = "123A456B789C*0#D";
+    constexpr uint32_t rows[] = {697, 770, 852, 941};
+    constexpr uint32_t cols[] = {1209, 1336, 1477, 1633};
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint32_t low{}, high{};
+        EXPECT_TRUE(Pair::dtmf(keys[i], low, high)) << keys[i];
+        EXPECT_EQ(low, frequency_to_ftw(rows[i / 4])) << keys[i];
+        EXPECT_EQ(high, frequency_to_ftw(cols[i % 4])) << keys[i];
+    }
+    uint32_t low{}, high{};
+    EXPECT_TRUE(Pair::dtmf('a', low, high));
+    EXPECT_FALSE(Pair::dtmf('E', low, high));
+
+    // A single unit stands in for both, the skew is one CONTROL transaction
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+    Pair pair(*unit, *unit);
+    EXPECT_FALSE(pair.flip());
+    EXPECT_FALSE(pair.dtmf('E'));
+    // Out of range frequencies are rejected, not wrapped
+    EXPECT_FALSE(pair.writeTones(MAXIMUM_FREQ + 1, 1000));
+    EXPECT_FALSE(pair.writeTones(1000, UINT32_MAX));
+    EXPECT_EQ(unit->frequency0(), 1000U);
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        EXPECT_TRUE(pair.dtmf(keys[i])) << keys[i];
+        auto bank = unit->currentFrequencyBank();
+        EXPECT_EQ(read_control(unit.get()) & 0x40, bank ? 0x40 : 0x00);
+        EXPECT_EQ(bank ? unit->frequency1() : unit->frequency0(), cols[i % 4]);
+    }
+
+    auto& stat = pair.statistics();
+    EXPECT_EQ(stat.switches, 16U);
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_GT(stat.max_skew_us, 0U);
+    EXPECT_GE(stat.max_switch_us, stat.max_skew_us);
+    M5_LOGI("DTMF switch:%u us skew:%u us (max %u/%u)", stat.last_switch_us, stat.last_skew_us, stat.max_switch_us,
+            stat.max_skew_us);
+}
+
+TEST_P(TestDDS, FM)
+{
+    SCOPED_TRACE(ustr);
+
+    // Table
+    FM::Frame frames[256]{};
+    EXPECT_FALSE(FM::generate(frames, 15, 10000, 2000));               // Odd
+    EXPECT_FALSE(FM::generate(frames, 16, 1000, 2000));                // Below 0Hz
+    EXPECT_FALSE(FM::generate(frames, 16, MAXIMUM_FREQ - 1000, 2000));  // Above 1MHz
+    EXPECT_FALSE(FM::generate(frames, 16, UINT32_MAX, 1));               // Above 1MHz (wraps in 32-bit)
+
+    EXPECT_TRUE(FM::generate(frames, 16, 10000, 2000, FM::Waveform::Triangle));
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint32_t expected = (i <= 4) ? 10000 + i * 500 : (i <= 12) ? 14000 - i * 500 : i * 500 + 2000;
+        EXPECT_EQ(ftw_to_frequency(codec::decode_ftw(frames[i].data)), expected) << i;
+        EXPECT_EQ(codec::decode_select(frames[i].data[0]), (i & 1) != 0) << i;
+    }
+    EXPECT_TRUE(FM::generate(frames, 16, 10000, 2000, FM::Waveform::Sine));
+    EXPECT_EQ(codec::decode_ftw(frames[0].data), frequency_to_ftw(10000));
+    EXPECT_EQ(codec::decode_ftw(frames[4].data), frequency_to_ftw(12000));
+    EXPECT_EQ(codec::decode_ftw(frames[12].data), frequency_to_ftw(8000));
+
+    // Play
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+    FM fm(*unit);
+    EXPECT_FALSE(fm.play(100));
+    EXPECT_GT(fm.measure(), 0U);
+
+    auto samples = fm.prepare(frames, m5::stl::size(frames), 10000, 2000, 50);
+    EXPECT_GE(samples, 2U);
+    EXPECT_EQ(samples % 2, 0U);
+    EXPECT_EQ(fm.sampleRate(), samples * 50U);
+    EXPECT_FALSE(fm.play(UINT32_MAX / 1000U + 1));  // Over 32-bit us
+    EXPECT_TRUE(fm.play(200));
+
+    auto& stat = fm.statistics();
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_EQ(stat.samples, fm.sampleRate() / 5);
+    EXPECT_GE(stat.duration_us, 200 * 1000U);
+    EXPECT_NEAR(stat.sample_rate, fm.sampleRate(), fm.sampleRate() / 50 + 1);
+    EXPECT_EQ(read_control(unit.get()) & 0x40, unit->control() & 0x40);
+    M5_LOGI("FM %zu samples/period, %u Hz (sample %u us, late %u us)", samples, stat.sample_rate, fm.sampleTime(),
+            stat.max_lateness);
+}
+
+TEST_P(TestDDS, Keyer)
+{
+    SCOPED_TRACE(ustr);
+
+    // Elements
+    Keyer::Element elements[64]{};
+    EXPECT_EQ(Keyer::morse(elements, 64, "S#", 100), 0U);
+    EXPECT_EQ(Keyer::morse(elements, 4, "SOS", 100), 0U);  // Not enough
+    EXPECT_EQ(Keyer::morse(elements, 64, " sos  e", 100), 19U);
+    constexpr uint32_t sos_e[] = {1, 1, 1, 1, 1, 3, 3, 1, 3, 1, 3, 3, 1, 1, 1, 1, 1, 7, 1};
+    for (uint32_t i = 0; i < 19; ++i) {
+        EXPECT_EQ(elements[i].on(), (i & 1) == 0) << i;
+        EXPECT_EQ(elements[i].us(), sos_e[i] * 100) << i;
+    }
+    const uint8_t data[] = {0xCA};  // 11001010
+    EXPECT_EQ(Keyer::bits(elements, 64, data, 8, 560), 6U);
+    constexpr uint32_t bits_e[] = {2, 2, 1, 1, 1, 1};
+    for (uint32_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(elements[i].on(), (i & 1) == 0) << i;
+        EXPECT_EQ(elements[i].us(), bits_e[i] * 560) << i;
+    }
+    // Not merged beyond 31 bits
+    const uint8_t ones[] = {0xFF};
+    EXPECT_EQ(Keyer::bits(elements, 64, ones, 8, 0x30000000U), 4U);
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(elements[i].on()) << i;
+        EXPECT_EQ(elements[i].us(), 0x60000000U) << i;
+    }
+
+    // Key
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 700, 0));
+    EXPECT_TRUE(unit->key(false));
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x08);
+    EXPECT_TRUE(unit->key(true));
+    EXPECT_EQ(read_control(unit.get()) & 0x18, 0x00);
+
+    // Play SOS at 40 WPM
+    Keyer keyer(*unit);
+    EXPECT_FALSE(keyer.play(elements, 0));
+    auto n = Keyer::morse(elements, 64, "SOS", Keyer::dot_us(40));
+    EXPECT_TRUE(keyer.play(elements, n));
+
+    auto& stat = keyer.statistics();
+    EXPECT_EQ(stat.edges, n + 1);  // Key up at the end
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_GE(stat.duration_us, 27 * Keyer::dot_us(40));
+    EXPECT_LE(stat.min_latency_us, stat.max_latency_us);
+    EXPECT_EQ(read_control(unit.get()) & 0x08, 0x08);
+    M5_LOGI("Keyer edge latency %u - %u us, jitter %u us", stat.min_latency_us, stat.max_latency_us, stat.jitter_us);
+
+    EXPECT_TRUE(unit->wakeup());
+}
+
+TEST_P(TestDDS, Dither)
+{
+    SCOPED_TRACE(ustr);
+
+    EXPECT_TRUE(unit->writeOutput(Mode::Sin, false, 1000, 0));
+    Dither dither(*unit);
+    EXPECT_FALSE(dither.start(MAXIMUM_FREQ * 1000U + 1));
+    EXPECT_FALSE(dither.isActive());
+
+    // 1000.012 Hz is between FTW 26843 and 26844
+    constexpr uint32_t target{1000012};
+    EXPECT_TRUE(dither.start(target));
+    EXPECT_TRUE(dither.isActive());
+    EXPECT_EQ(dither.ftw(), 26843U);
+    EXPECT_GT(dither.fraction(), 0U);
+
+    auto start = m5::utility::millis();
+    while (m5::utility::millis() - start < 500) {
+        EXPECT_TRUE(dither.update());
+    }
+    dither.stop();
+    EXPECT_TRUE(dither.update());  // Nothing to do
+
+    auto& stat = dither.statistics();
+    EXPECT_GT(stat.switches, 0U);
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_GT(stat.lower_us, 0U);
+    EXPECT_GT(stat.upper_us, stat.lower_us);  // Fraction is about 0.87
+    EXPECT_NEAR(dither.averageMillihertz(), target, 2);
+    EXPECT_EQ(read_control(unit.get()) & 0x40, unit->control() & 0x40);
+    M5_LOGI("Dither avg:%u mHz switches:%u", dither.averageMillihertz(), stat.switches);
+}
+
+TEST_P(TestDDS, Group)
+{
+    SCOPED_TRACE(ustr);
+
+    Group group;
+    EXPECT_FALSE(group.start(Group::Setting{Mode::Sin, 1000, 0}));
+    EXPECT_FALSE(group.release());
+
+    // A single unit stands in for the group
+    EXPECT_TRUE(group.add(*unit));
+    EXPECT_EQ(group.size(), 1U);
+
+    EXPECT_TRUE(group.hold());
+    EXPECT_EQ(read_control(unit.get()) & 0x1C, 0x04);
+    EXPECT_TRUE(group.program(0, Group::Setting{Mode::Triangle, 2000, 90}));
+    EXPECT_FALSE(group.program(1, Group::Setting{Mode::Sin, 1000, 0}));
+    EXPECT_EQ(read_control(unit.get()) & 0x1C, 0x04);  // Still held
+    EXPECT_EQ(unit->frequency0(), 2000U);
+    EXPECT_EQ(unit->snapshot().deg[0], 90U);
+    EXPECT_TRUE(group.release());
+    EXPECT_EQ(read_control(unit.get()) & 0x1C, 0x00);
+    EXPECT_EQ(group.releaseOffset(0), 0U);
+
+    const Group::Setting settings[] = {{Mode::Sin, 1000, 180}};
+    EXPECT_TRUE(group.start(settings));
+    EXPECT_EQ(read_control(unit.get()) & 0x1C, 0x00);
+    EXPECT_EQ(unit->snapshot().mode, Mode::Sin);
+    EXPECT_EQ(unit->frequency0(), 1000U);
+
+    auto& stat = group.statistics();
+    EXPECT_EQ(stat.starts, 1U);
+    EXPECT_EQ(stat.failed, 1U);  // No units
+    EXPECT_EQ(stat.last_skew_us, 0U);
+
+    while (group.add(*unit)) {
+    }
+    EXPECT_EQ(group.size(), Group::MAX_UNITS);
+    EXPECT_TRUE(group.start(Group::Setting{Mode::Sin, 1000, 0}));
+    EXPECT_GT(stat.last_skew_us, 0U);
+    EXPECT_GE(group.releaseOffset(Group::MAX_UNITS - 1), group.releaseOffset(1));
+    M5_LOGI("Release skew of %zu units:%u us", group.size(), stat.last_skew_us);
+}
+
+TEST_P(TestDDS, BeginBenchmark)
+{
+    SCOPED_TRACE(ustr);
+
+    // Fused start leaves the same state as writeOutput + wakeup
+    auto cfg = unit->config();
+    EXPECT_TRUE(unit->begin());
+    EXPECT_EQ(read_control(unit.get()) & 0x7C, cfg.select ? 0x60 : 0x00);
+    EXPECT_EQ(unit->frequency0(), cfg.freq);
+
+    auto fast              = cfg;
+    fast.check_description = false;
+    fast.hold_reset        = true;
+    unit->config(fast);
+    EXPECT_TRUE(unit->begin());
+    EXPECT_EQ(read_control(unit.get()) & 0x1C, 0x04);  // Held
+    EXPECT_TRUE(unit->writeReset(false));
+    unit->config(cfg);
+
+    // The same unit stands in for each unit of the fleet
+    for (size_t n : {1U, 4U, 8U}) {
+        auto start = m5::utility::micros();
+        for (size_t i = 0; i < n; ++i) {
+            char desc[7]{};
+            EXPECT_TRUE(unit->readDescription(desc));
+            EXPECT_TRUE(unit->writeOutput(cfg.mode, cfg.select, cfg.freq, cfg.deg));
+            EXPECT_TRUE(unit->wakeup());
+        }
+        const uint32_t legacy_us = m5::utility::micros() - start;
+
+        start = m5::utility::micros();
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_TRUE(unit->begin());
+        }
+        const uint32_t begin_us = m5::utility::micros() - start;
+
+        unit->config(fast);
+        Group group;
+        start = m5::utility::micros();
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_TRUE(unit->begin());  // Programmed and held
+            group.add(*unit);
+        }
+        EXPECT_TRUE(group.release());
+        const uint32_t fleet_us = m5::utility::micros() - start;
+        unit->config(cfg);
+
+        EXPECT_LT(begin_us, legacy_us) << n;
+        EXPECT_LT(fleet_us, begin_us) << n;
+        M5_LOGI("Start %zu units: legacy:%u us begin:%u us fleet:%u us", n, legacy_us, begin_us, fleet_us);
+    }
+}
+
+TEST_P(TestDDS, Queue)
+{
+    SCOPED_TRACE(ustr);
+
+    CommandQueue queue(4);
+    EXPECT_EQ(queue.update(), 0U);
+
+    EXPECT_TRUE(queue.push(*unit, Op::frequency(true, 1234)));
+    EXPECT_TRUE(queue.push(*unit, Op::phase(true, 90)));
+    EXPECT_TRUE(queue.push(*unit, Op::mode(Mode::Triangle)));
+    EXPECT_TRUE(queue.push(*unit, Op::current(true, true)));
+    EXPECT_FALSE(queue.push(*unit, Op::current(false, false)));  // Full
+    EXPECT_EQ(queue.pending(), 4U);
+
+    EXPECT_EQ(queue.update(), 4U);
+    EXPECT_EQ(queue.pending(), 0U);
+    EXPECT_EQ(unit->frequency1(), 1234U);
+    EXPECT_EQ(read_control(unit.get()) & 0x60, 0x60);
+
+    auto& stat = queue.statistics();
+    EXPECT_EQ(stat.executed, 4U);
+    EXPECT_EQ(stat.failed, 0U);
+    EXPECT_EQ(stat.batches, 1U);  // A unit in a single batch
+    // Not behind a hub
+    EXPECT_EQ(stat.channel_switches, 0U);
+    EXPECT_EQ(stat.switches_saved, 0U);
+
+    EXPECT_TRUE(queue.push(*unit, Op::frequency(false, MAXIMUM_FREQ + 1)));
+    EXPECT_EQ(queue.update(), 0U);
+    EXPECT_EQ(stat.failed, 1U);
+
+    EXPECT_TRUE(queue.push(*unit, Op::mode(Mode::Sin)));
+    queue.clear();
+    EXPECT_EQ(queue.pending(), 0U);
+    EXPECT_TRUE(unit->writeMode(Mode::Sin));
+}
+
+TEST_P(TestDDS, QueueCoalescing)
+{
+    SCOPED_TRACE(ustr);
+
+    CommandQueue queue(4);
+    queue.coalescing(true);
+    EXPECT_TRUE(queue.coalescing());
+
+    for (uint32_t f = 1000; f < 1100; ++f) {
+        EXPECT_TRUE(queue.push(*unit, Op::frequency(false, f)));
+    }
+    EXPECT_TRUE(queue.push(*unit, Op::phase(true, 10)));
+    EXPECT_TRUE(queue.push(*unit, Op::phase(true, 20)));
+    // Never replaced, nor replaced across
+    EXPECT_TRUE(queue.push(*unit, Op::sleep(false, false)));
+    EXPECT_TRUE(queue.push(*unit, Op::frequency(false, 2000)));
+    EXPECT_FALSE(queue.push(*unit, Op::frequency(true, 3000)));  // Full
+    EXPECT_TRUE(queue.push(*unit, Op::frequency(false, 2001)));  // Replaces even if full
+    EXPECT_EQ(queue.pending(), 4U);
+
+    auto& stat = queue.statistics();
+    EXPECT_EQ(stat.coalesced, 99U + 1U + 1U);
+
+    EXPECT_EQ(queue.update(), 4U);
+    EXPECT_EQ(unit->frequency0(), 2001U);
+    EXPECT_EQ(unit->snapshot().deg[1], 20U);
+    EXPECT_GE(stat.max_age_us, stat.last_age_us);
+
+    queue.coalescing(false);
+    EXPECT_TRUE(queue.push(*unit, Op::frequency(false, 1000)));
+    EXPECT_TRUE(queue.push(*unit, Op::frequency(false, 1001)));
+    EXPECT_EQ(queue.pending(), 2U);
+    EXPECT_EQ(queue.update(), 2U);
+    EXPECT_EQ(unit->frequency0(), 1001U);
+}
+
+TEST_P(TestDDS, ClockTuner)
+{
+    SCOPED_TRACE(ustr);
+
+    const auto org = unit->component_config().clock;
+
+    // The callback applies the clock to the bus
+    uint32_t applied{};
+    auto set_clock = [&applied](const uint32_t clock) {
+        Wire.setClock(clock);
+        applied = clock;
+        return true;
+    };
+
+    ClockTuner tuner(set_clock);
+    EXPECT_TRUE(tuner.tune(*unit));
+    ASSERT_GE(tuner.steps(), 1U);
+    EXPECT_LE(tuner.steps(), 5U);
+    // The limit depends on the wiring, probing stops at the first clock with an error
+    const size_t probed = tuner.steps() - (tuner.failedClock() ? 1 : 0);
+    uint32_t reliable{};
+    for (size_t i = 0; i < tuner.steps(); ++i) {
+        auto& r = tuner.result(i);
+        EXPECT_EQ(r.clock, tuner.config().clocks[i]);
+        if (i < probed) {
+            EXPECT_EQ(r.transactions, 64U);
+            EXPECT_EQ(r.errors, 0U);
+            reliable = r.clock;
+        } else {
+            EXPECT_EQ(r.clock, tuner.failedClock());
+        }
+    }
+    // The highest clock with zero errors
+    EXPECT_NE(reliable, 0U);
+    EXPECT_EQ(tuner.clock(), reliable);
+    EXPECT_EQ(applied, tuner.clock());
+    EXPECT_EQ(tuner.margin(), tuner.failedClock() ? tuner.failedClock() - reliable : 0U);
+    EXPECT_EQ(unit->component_config().clock, tuner.clock());
+    // Reliable at the chosen clock
+    uint32_t errors{};
+    EXPECT_TRUE(unit->probeLink(16, errors));
+    EXPECT_EQ(errors, 0U);
+
+    // Driver refuses above 400 kHz, when the wiring allows 400 kHz
+    if (tuner.clock() >= 400 * 1000U) {
+        ClockTuner limited([&set_clock](const uint32_t clock) { return clock <= 400 * 1000U && set_clock(clock); });
+        auto cfg        = limited.config();
+        cfg.guard_steps = 1;
+        limited.config(cfg);
+        EXPECT_TRUE(limited.tune(*unit));
+        EXPECT_EQ(limited.clock(), 100 * 1000U);
+        EXPECT_EQ(applied, limited.clock());
+        EXPECT_EQ(limited.failedClock(), 600 * 1000U);
+        EXPECT_EQ(limited.margin(), 500 * 1000U);
+        EXPECT_EQ(limited.steps(), 3U);
+        EXPECT_EQ(limited.result(0).errors, 0U);
+        EXPECT_EQ(limited.result(1).errors, 0U);
+        errors = 0;
+        EXPECT_TRUE(unit->probeLink(16, errors));
+        EXPECT_EQ(errors, 0U);
+    }
+
+    Wire.setClock(org);
+    auto ccfg  = unit->component_config();
+    ccfg.clock = org;
+    unit->component_config(ccfg);
+}
+
+namespace {
+
+// UnitDDS over the simulator instead of the I2C bus
+class SimulatedUnitDDS : public UnitDDS {
+public:
+    bus::Simulator sim{};
+
+    const dds::BasicUnitDDS<ComponentBus>& core() const
+    {
+        return _core;
+    }
+
+protected:
+    virtual bool read_transaction(const uint8_t reg, uint8_t* buf, const size_t len) override
+    {
+        return sim.read(reg, buf, len);
+    }
+    virtual bool write_transaction(const uint8_t reg, const uint8_t* buf, const size_t len) override
+    {
+        return sim.write(reg, buf, len);
+    }
+};
+
+class HookedSimulatedUnitDDS : public SimulatedUnitDDS {
+public:
+    std::function<void(const uint8_t reg, const uint8_t* buf)> on_write{};  // Called before each write transaction
+
+protected:
+    virtual bool write_transaction(const uint8_t reg, const uint8_t* buf, const size_t len) override
+    {
+        if (on_write) {
+            on_write(reg, buf);
+        }
+        return SimulatedUnitDDS::write_transaction(reg, buf, len);
+    }
+};
+
+// Calls of UnitDDS in addition to dds_fuzz::apply
+dds_fuzz::Result apply_unit(SimulatedUnitDDS& u, const uint8_t op, dds_fuzz::Input& in)
+{
+    using dds_fuzz::Result;
+    const bool s1 = in.flag();
+    const bool s2 = in.flag();
+    switch (op % 5) {
+        case 0: {  // Batch with invalid operations
+            Op ops[6]{};
+            bool results[6]{}, valid[6]{};
+            const size_t count = 1 + in.u8() % 6;
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t t  = in.u8();
+                const bool b1    = t & 0x08;
+                const bool b2    = t & 0x10;
+                const uint32_t f = dds_fuzz::frequency(in);
+                const uint8_t m  = in.u8() % 8;
+                switch (t % 5) {
+                    case 0:
+                        ops[i]   = Op::frequency(b1, f);
+                        valid[i] = f <= codec::MAXIMUM_FREQ;
+                        break;
+                    case 1:
+                        ops[i]   = Op::phase(b1, dds_fuzz::degree(in));
+                        valid[i] = true;
+                        break;
+                    case 2:
+                        ops[i]   = Op(Op::Type::Mode, false, false, m);
+                        valid[i] = codec::is_valid_mode(m);
+                        break;
+                    case 3:
+                        ops[i]   = Op::current(b1, b2);
+                        valid[i] = true;
+                        break;
+                    default:
+                        ops[i]   = Op::sleep(b1, b2);
+                        valid[i] = true;
+                        break;
+                }
+            }
+            u.writeBatch(ops, count, results);
+            bool ok{true};
+            for (size_t i = 0; i < count; ++i) {
+                if (!valid[i] && results[i]) {
+                    return Result::Accepted;
+                }
+                ok &= !valid[i] || results[i];
+            }
+            return ok ? Result::Ok : Result::Failed;
+        }
+        case 1: {  // Idle sleep, woken by the next output command
+            u.idleSleep(1, s1 || !s2, s2);
+            m5::utility::delay(2);
+            u.update();
+            u.idleSleep(0);
+            return u.controlValid() ? Result::Ok : Result::Failed;
+        }
+        case 2:
+            return u.resync() ? Result::Ok : Result::Failed;
+        case 3:
+            return u.writeUrgent(in.flag() ? Op::current(s1, s2) : Op::sleep(s1, s2)) ? Result::Ok : Result::Failed;
+        default:
+            return u.key(s1) ? Result::Ok : Result::Failed;
+    }
+}
+
+// Returns the empty string if the shadow of UnitDDS stays consistent with the simulator
+std::string run_unit(const uint8_t* data, const size_t size, power_statistics_t& power)
+{
+    using dds_fuzz::Result;
+    dds_fuzz::Input in(data, size);
+    SimulatedUnitDDS u;
+    auto& sim = u.sim;
+    if (!u.begin()) {
+        return "begin failed";
+    }
+    uint32_t step{};
+    while (!in.empty()) {
+        const uint8_t op = in.u8();
+        dds_fuzz::inject(sim, in);
+        const uint32_t traffic = sim.writes() + sim.reads();
+        const bool extra       = op >= 0xC0;
+        const Result r         = extra ? apply_unit(u, op, in) : dds_fuzz::apply(u, op, in);
+        if (r == Result::Accepted) {
+            return "invalid arguments accepted at step " + std::to_string(step);
+        }
+        if (r == Result::Rejected && sim.writes() + sim.reads() != traffic) {
+            return "rejected call touched the bus at step " + std::to_string(step) + " op " +
+                   std::to_string(op % dds_fuzz::APPLY_OPS);
+        }
+        if (r == Result::Failed) {
+            auto e = dds_fuzz::recover(u, sim);
+            if (!e.empty()) {
+                return e;
+            }
+        }
+        sim.clearFaults();
+        auto e = dds_fuzz::check(u.core(), sim);
+        if (!e.empty()) {
+            return e + " at step " + std::to_string(step) + (extra ? " unit op " : " op ") +
+                   std::to_string(op % (extra ? 5 : dds_fuzz::APPLY_OPS));
+        }
+        ++step;
+    }
+    power.sleeps += u.powerStatistics().sleeps;
+    power.wakes += u.powerStatistics().wakes;
+    return {};
+}
+
+}  // namespace
+
+// Shadow, batching, idle sleep and restore of UnitDDS under random calls and bus faults
+TEST(SimulatedDDS, Fuzz)
+{
+    std::mt19937 rng(20250101);
+    std::uniform_int_distribution<int> dist(0, 255);
+    power_statistics_t power{};
+    for (int i = 0; i < 200; ++i) {
+        std::vector<uint8_t> v(16 + (i % 256));
+        for (auto& b : v) {
+            b = static_cast<uint8_t>(dist(rng));
+        }
+        const auto e = run_unit(v.data(), v.size(), power);
+        EXPECT_TRUE(e.empty()) << "#" << i << " " << e;
+        if (!e.empty()) {
+            break;
+        }
+    }
+    // Idle sleep and the wake by the next command are exercised
+    EXPECT_GT(power.sleeps, 0U);
+    EXPECT_GT(power.wakes, 0U);
+}
+
+// Transactions of the first command after idle sleep
+TEST(SimulatedDDS, IdleSleepTransactions)
+{
+    SimulatedUnitDDS u;
+    auto& sim = u.sim;
+    ASSERT_TRUE(u.begin());
+
+    auto sleep_idle = [&u]() {
+        u.idleSleep(1);
+        m5::utility::delay(2);
+        u.update();
+        u.idleSleep(0);
+        return u.isIdleSleeping();
+    };
+
+    // Current bank: wakes in the same CONTROL write, no more than awake
+    uint32_t writes = sim.writes();
+    EXPECT_TRUE(u.writeCurrent(true, true));
+    const uint32_t current_awake = sim.writes() - writes;
+    ASSERT_TRUE(sleep_idle());
+    writes = sim.writes();
+    EXPECT_TRUE(u.writeCurrent(false, false));
+    EXPECT_EQ(sim.writes() - writes, current_awake);
+    EXPECT_FALSE(u.isIdleSleeping());
+    EXPECT_EQ(sim.control() & 0x18, 0x00);
+
+    // Frequency only: MODE/CONTROL and FREQUENCY cannot share a burst, one more CONTROL write at the end
+    writes = sim.writes();
+    EXPECT_TRUE(u.writeFrequency(false, 2000));
+    const uint32_t freq_awake = sim.writes() - writes;
+    ASSERT_TRUE(sleep_idle());
+    writes = sim.writes();
+    EXPECT_TRUE(u.writeFrequency(false, 3000));
+    EXPECT_EQ(sim.writes() - writes, freq_awake + 1);
+    EXPECT_FALSE(u.isIdleSleeping());
+    EXPECT_EQ(sim.control() & 0x18, 0x00);
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(3000));
+
+    // Nothing is read to wake
+    ASSERT_TRUE(sleep_idle());
+    const uint32_t reads = sim.reads();
+    EXPECT_TRUE(u.writeFrequencyAndPhase(true, 4000, true, 90));
+    EXPECT_EQ(sim.reads(), reads);
+    EXPECT_EQ(u.powerStatistics().wakes, 3U);
+}
+
+// Both banks on the registers after leaving Sawtooth/DC
+TEST(SimulatedDDS, ModeRestore)
+{
+    SimulatedUnitDDS u;
+    auto& sim = u.sim;
+    ASSERT_TRUE(u.begin());
+
+    // Odd FTW not representable in integer Hz
+    EXPECT_TRUE(u.writeMode(Mode::Sin));
+    EXPECT_TRUE(u.writeFrequencyWord(false, 123457));
+    EXPECT_TRUE(u.writeFrequencyAndPhase(true, 5000, true, 90));
+    const uint32_t ftw0 = sim.ftw(false);
+    const uint32_t ftw1 = sim.ftw(true);
+    EXPECT_EQ(ftw0, 123457U);
+    EXPECT_EQ(ftw1, frequency_to_ftw(5000));
+
+    for (auto&& mode : {Mode::Sawtooth, Mode::Triangle, Mode::DC, Mode::Square, Mode::Sawtooth, Mode::DC, Mode::Sin}) {
+        EXPECT_TRUE(u.writeMode(mode));
+        EXPECT_EQ(sim.mode() & 0x07, static_cast<uint8_t>(mode));
+        if (codec::is_frequency_ignored(mode)) {
+            // Cleared by the firmware
+            EXPECT_EQ(sim.ftw(false), 0U);
+            EXPECT_EQ(sim.ftw(true), 0U);
+        } else {
+            EXPECT_EQ(sim.ftw(false), ftw0) << (int)mode;
+            EXPECT_EQ(sim.ftw(true), ftw1) << (int)mode;
+        }
+        EXPECT_EQ(sim.phase(true), degree_to_phase(90));
+    }
+
+    // MODE is not read by writeMode, a change by another master is not picked up until readMode
+    const uint8_t saw = static_cast<uint8_t>(Mode::Sawtooth) | 0x80;
+    EXPECT_TRUE(sim.write(MODE_REG, &saw, 1));
+    EXPECT_TRUE(u.writeMode(Mode::Triangle));
+    EXPECT_EQ(sim.ftw(false), 0U);  // Not restored
+    EXPECT_TRUE(sim.write(MODE_REG, &saw, 1));
+    Mode m{};
+    EXPECT_TRUE(u.readMode(m));
+    EXPECT_EQ(m, Mode::Sawtooth);
+    EXPECT_TRUE(u.writeMode(Mode::Triangle));
+    EXPECT_EQ(sim.ftw(false), ftw0);
+    EXPECT_EQ(sim.ftw(true), ftw1);
+}
+
+// Sleep operation of writeBatch while idle sleeping is kept, not woken
+TEST(SimulatedDDS, BatchSleepWhileIdle)
+{
+    SimulatedUnitDDS u;
+    auto& sim = u.sim;
+    ASSERT_TRUE(u.begin());
+
+    u.idleSleep(1, false, true);
+    m5::utility::delay(2);
+    u.update();
+    u.idleSleep(0);
+    ASSERT_TRUE(u.isIdleSleeping());
+    EXPECT_EQ(sim.control() & 0x18, 0x08);
+
+    // Nothing to write is no activity
+    const Op ops[] = {Op::current(true, true), Op::sleep(true, true)};
+    EXPECT_EQ(u.writeBatch(nullptr, 2), 0U);
+    EXPECT_EQ(u.writeBatch(ops, 0), 0U);
+    EXPECT_TRUE(u.isIdleSleeping());
+    EXPECT_EQ(sim.control() & 0x18, 0x08);
+
+    EXPECT_EQ(u.writeBatch(ops), 2U);
+    EXPECT_FALSE(u.isIdleSleeping());  // Sleeping by the user
+    EXPECT_EQ(sim.control() & 0x78, 0x78);
+    EXPECT_EQ(u.powerStatistics().wakes, 0U);
+
+    // Not woken by the next command
+    EXPECT_TRUE(u.writeFrequency(false, 2000));
+    EXPECT_EQ(sim.control() & 0x18, 0x18);
+    EXPECT_TRUE(u.wakeup());
+    EXPECT_EQ(sim.control() & 0x18, 0x00);
+}
+
+// A tone holds the output without writes, it is not idle
+TEST(SimulatedDDS, IdleSleepWhilePlaying)
+{
+    SimulatedUnitDDS u;
+    auto& sim = u.sim;
+    ASSERT_TRUE(u.begin());
+
+    const Tone held[] = {tone(1000, 60000)};
+    ASSERT_TRUE(u.playTones(held));
+    u.idleSleep(20);
+    m5::utility::delay(30);
+    u.update();
+    EXPECT_FALSE(u.isIdleSleeping());
+    EXPECT_EQ(sim.control() & 0x18, 0x00);
+
+    u.stopTones();
+    m5::utility::delay(30);
+    u.update();
+    EXPECT_TRUE(u.isIdleSleeping());
+
+    // wakeup() is activity, the timer starts over
+    EXPECT_TRUE(u.wakeup());
+    EXPECT_FALSE(u.isIdleSleeping());
+    u.update();
+    EXPECT_FALSE(u.isIdleSleeping());
+    EXPECT_EQ(sim.control() & 0x18, 0x00);
+    u.idleSleep(0);
+}
+
+// A flip with the lost ACK is applied, the next frame still goes to the inactive bank
+TEST(SimulatedDDS, FMLostAck)
+{
+    HookedSimulatedUnitDDS u;
+    auto& sim = u.sim;
+    ASSERT_TRUE(u.begin());
+
+    FM::Frame frames[16]{};
+    FM fm(u);
+    ASSERT_NE(fm.prepare(frames, m5::stl::size(frames), 10000, 2000, 1000), 0U);
+
+    uint32_t controls{}, active{};
+    u.on_write = [&](const uint8_t reg, const uint8_t* buf) {
+        if (reg == CONTROL_REG && ++controls == 4) {
+            sim.loseAckNext(1);
+        }
+        // The frame must not rewrite the output bank
+        if (reg == FREQUENCY_REG && codec::decode_select(buf[0]) == static_cast<bool>(sim.control() & 0x40)) {
+            ++active;
+        }
+    };
+    fm.play(20);
+    u.on_write = nullptr;
+
+    EXPECT_EQ(fm.statistics().failed, 1U);
+    EXPECT_GT(fm.statistics().samples, 4U);
+    EXPECT_EQ(active, 0U);
+    EXPECT_EQ(u.currentFrequencyBank(), static_cast<bool>(sim.control() & 0x40));
+}
+
+// MODE and CONTROL garbled at a failing clock are written back from the baseline, not taken by resync
+TEST(SimulatedDDS, ClockTunerRestore)
+{
+    SimulatedUnitDDS u;
+    auto& sim = u.sim;
+    ASSERT_TRUE(u.begin());
+    EXPECT_TRUE(u.writeOutput(Mode::Triangle, true, 2000, 90));
+    const uint8_t mode = sim.mode();
+    const uint8_t ctrl = sim.control();
+
+    ClockTuner tuner([&sim](const uint32_t clock) {
+        if (clock > 400 * 1000U) {
+            // A garbled write sets Sawtooth, SLEEP and RESET, and a transaction fails
+            const uint8_t garbled[2] = {0x80 | static_cast<uint8_t>(Mode::Sawtooth), 0x80 | 0x1C};
+            sim.write(MODE_REG, garbled, 2);
+            sim.failNext(1);
+        }
+        return true;
+    });
+    EXPECT_TRUE(tuner.tune(u));
+    EXPECT_EQ(tuner.clock(), 400 * 1000U);
+    EXPECT_EQ(tuner.failedClock(), 600 * 1000U);
+    EXPECT_EQ(sim.mode(), mode);
+    EXPECT_EQ(sim.control(), ctrl);
+    EXPECT_EQ(u.control(), ctrl);
+    EXPECT_EQ(sim.ftw(true), frequency_to_ftw(2000));
+}
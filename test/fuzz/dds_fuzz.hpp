@@ -0,0 +1,330 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  Fuzz harness for BasicUnitDDS against the simulator
+
+  Input bytes are decoded into a sequence of API calls with random arguments and bus faults.
+  After each call the cached state of the driver is compared with the register state of the simulator.
+  The same sequence runs over the direct simulator bus and, on Linux, over the batching i2c-dev bus.
+  apply, check and recover take any driver with the API of BasicUnitDDS,
+  UnitDDS over the simulator is run by the embedded test (See also test/embedded/test_dds)
+*/
+#ifndef M5_UNIT_DDS_TEST_DDS_FUZZ_HPP
+#define M5_UNIT_DDS_TEST_DDS_FUZZ_HPP
+
+#include <unit/dds_basic.hpp>
+#include <unit/dds_simulator.hpp>
+#include "simulator_ioctl.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace dds_fuzz {
+
+using namespace m5::unit::dds;
+
+// Reads the input as a byte stream, zero after the end
+class Input {
+public:
+    Input(const uint8_t* data, const size_t size) : _data(data), _size(size)
+    {
+    }
+    bool empty() const
+    {
+        return _pos >= _size;
+    }
+    uint8_t u8()
+    {
+        return _pos < _size ? _data[_pos++] : 0;
+    }
+    uint16_t u16()
+    {
+        return static_cast<uint16_t>(u8() | (u8() << 8));
+    }
+    uint32_t u32()
+    {
+        return static_cast<uint32_t>(u16()) | (static_cast<uint32_t>(u16()) << 16);
+    }
+    bool flag()
+    {
+        return u8() & 1;
+    }
+
+private:
+    const uint8_t* _data{};
+    size_t _size{}, _pos{};
+};
+
+// Boundary values including out of range (invalid_freq_table, deg_table of the embedded test)
+inline uint32_t frequency(Input& in)
+{
+    static constexpr uint32_t table[] = {0, 1, 1000, 13600, 999999, 1000000, 1000001, 0xFFFFFFFF};
+    const uint8_t v = in.u8();
+    return (v & 0x80) ? in.u32() % 1100000 : table[v & 7];
+}
+inline uint16_t degree(Input& in)
+{
+    static constexpr uint16_t table[] = {0, 1, 90, 180, 359, 360, 361, 0xFFFF};
+    const uint8_t v = in.u8();
+    return (v & 0x80) ? in.u16() : table[v & 7];
+}
+
+enum class Result {
+    Ok,        // Succeeded
+    Failed,    // Failed by the bus
+    Rejected,  // Invalid arguments are rejected, must not touch the bus
+    Accepted,  // Invalid arguments are accepted (bug)
+};
+
+// Number of the calls of apply
+constexpr uint8_t APPLY_OPS{15};
+
+// Applies one call
+template <class Driver>
+Result apply(Driver& dds, const uint8_t op, Input& in)
+{
+    const bool s1 = in.flag();
+    const bool s2 = in.flag();
+    bool ok{};
+    switch (op % APPLY_OPS) {
+        case 0: {
+            const uint32_t f = frequency(in);
+            if (f > codec::MAXIMUM_FREQ) {
+                return dds.writeFrequency(s1, f) ? Result::Accepted : Result::Rejected;
+            }
+            ok = dds.writeFrequency(s1, f);
+        } break;
+        case 1: {
+            const uint32_t w = in.u32() % (frequency_to_ftw(codec::MAXIMUM_FREQ) + 1000);
+            if (!codec::is_valid_ftw(w)) {
+                return dds.writeFrequencyWord(s1, w) ? Result::Accepted : Result::Rejected;
+            }
+            ok = dds.writeFrequencyWord(s1, w);
+        } break;
+        case 2:
+            ok = dds.writePhase(s1, degree(in));
+            break;
+        case 3: {
+            const uint32_t f = frequency(in);
+            const uint16_t d = degree(in);
+            if (f > codec::MAXIMUM_FREQ) {
+                return dds.writeFrequencyAndPhase(s1, f, s2, d) ? Result::Accepted : Result::Rejected;
+            }
+            ok = dds.writeFrequencyAndPhase(s1, f, s2, d);
+        } break;
+        case 4:
+            ok = dds.writeCurrent(s1, s2);
+            break;
+        case 5:
+            ok = dds.writeCurrentFrequency(s1);
+            break;
+        case 6:
+            ok = dds.writeCurrentPhase(s1);
+            break;
+        case 7:
+            ok = dds.writeMode(static_cast<Mode>(in.u8() % 6));
+            break;
+        case 8: {
+            const Mode m     = static_cast<Mode>(in.u8() % 6);
+            const uint32_t f = frequency(in);
+            const uint16_t d = degree(in);
+            if (f > codec::MAXIMUM_FREQ) {
+                return dds.writeOutput(m, s1, f, d) ? Result::Accepted : Result::Rejected;
+            }
+            ok = dds.writeOutput(m, s1, f, d);
+        } break;
+        case 9:
+            if (!s1 && !s2) {
+                return dds.sleep(s1, s2) ? Result::Accepted : Result::Rejected;
+            }
+            ok = dds.sleep(s1, s2);
+            break;
+        case 10:
+            ok = dds.wakeup();
+            break;
+        case 11:
+            ok = dds.reset();
+            break;
+        case 12: {
+            Mode m{};
+            ok = dds.readMode(m);
+        } break;
+        case 13: {
+            uint8_t c{};
+            ok = dds.readControl(c);
+        } break;
+        default:
+            ok = dds.begin();
+            break;
+    }
+    return ok ? Result::Ok : Result::Failed;
+}
+
+// Compares the cache with the registers, returns the reason of the mismatch
+template <class Driver>
+std::string check(const Driver& dds, const bus::Simulator& sim)
+{
+    char msg[96]{};
+    if (dds.controlValid() && dds.control() != sim.control()) {
+        snprintf(msg, sizeof(msg), "CONTROL %02X != %02X", dds.control(), sim.control());
+        return msg;
+    }
+    const Mode mode = static_cast<Mode>(sim.mode() & 0x07);
+    if (dds.mode() != mode) {
+        snprintf(msg, sizeof(msg), "MODE %u != %u", (unsigned)dds.mode(), (unsigned)mode);
+        return msg;
+    }
+    for (int b = 0; b < 2; ++b) {
+        // Frequencies are cleared in Sawtooth/DC, and written back when leaving
+        if (!codec::is_frequency_ignored(mode) && dds.frequencyWord(b) != sim.ftw(b)) {
+            snprintf(msg, sizeof(msg), "FTW%d %08X != %08X", b, dds.frequencyWord(b), sim.ftw(b));
+            return msg;
+        }
+        if (degree_to_phase(dds.phase(b)) != sim.phase(b)) {
+            snprintf(msg, sizeof(msg), "PHASE%d %03X != %03X", b, degree_to_phase(dds.phase(b)), sim.phase(b));
+            return msg;
+        }
+    }
+    return {};
+}
+
+// Injects the fault for the next call
+inline void inject(bus::Simulator& sim, Input& in)
+{
+    const uint8_t f = in.u8();
+    if ((f & 0x0F) == 0x01) {
+        sim.failNext(1 + (f >> 6));
+    } else if ((f & 0x0F) == 0x02) {
+        sim.loseAckNext(1 + (f >> 6));
+    }
+}
+
+// Recovery after a failed call as the application does
+template <class Driver>
+std::string recover(Driver& dds, bus::Simulator& sim)
+{
+    sim.clearFaults();
+    return dds.resync() ? std::string{} : std::string{"resync failed"};
+}
+
+/*
+  Runs the input over the direct simulator bus
+  Returns the empty string if the cache stays consistent
+ */
+inline std::string run_direct(const uint8_t* data, const size_t size)
+{
+    Input in(data, size);
+    BasicUnitDDS<bus::Simulator> dds;
+    auto& sim = dds.bus();
+    if (!dds.begin()) {
+        return "begin failed";
+    }
+    uint32_t step{};
+    while (!in.empty()) {
+        const uint8_t op = in.u8();
+        inject(sim, in);
+        const uint32_t traffic = sim.writes() + sim.reads();
+        const Result r         = apply(dds, op, in);
+        if (r == Result::Accepted) {
+            return "invalid arguments accepted at step " + std::to_string(step);
+        }
+        if (r == Result::Rejected) {
+            if (sim.writes() + sim.reads() != traffic) {
+                return "rejected call touched the bus at step " + std::to_string(step);
+            }
+            sim.clearFaults();
+        } else if (r == Result::Failed) {
+            auto e = recover(dds, sim);
+            if (!e.empty()) {
+                return e;
+            }
+        }
+        sim.clearFaults();
+        auto e = check(dds, sim);
+        if (!e.empty()) {
+            return e + " at step " + std::to_string(step) + " op " + std::to_string(op % APPLY_OPS);
+        }
+        ++step;
+    }
+    return {};
+}
+
+#if defined(M5_UNIT_DDS_ENABLE_LINUX_BUS)
+/*
+  Runs the input over the i2c-dev bus with random batches
+  The cache is compared when no batch is pending
+ */
+inline std::string run_batched(const uint8_t* data, const size_t size)
+{
+    using LinuxBus = bus::BasicLinuxI2cBus<bus::SimulatorIoctl>;
+    Input in(data, size);
+    bus::Simulator sim;
+    BasicUnitDDS<LinuxBus> dds(-1, bus::DEFAULT_ADDRESS, bus::SimulatorIoctl(&sim));
+    if (!dds.begin()) {
+        return "begin failed";
+    }
+    uint32_t step{};
+    bool batching{};
+    while (!in.empty()) {
+        const uint8_t op = in.u8();
+        inject(sim, in);
+        if (!batching && (op & 0x80)) {
+            dds.bus().beginBatch();
+            batching = true;
+        }
+        const Result r = apply(dds, op, in);
+        if (r == Result::Accepted) {
+            return "invalid arguments accepted at step " + std::to_string(step) + " (batched)";
+        }
+        bool ok = r != Result::Failed;
+        if (batching && (!ok || (op & 0x40))) {
+            ok &= dds.bus().endBatch();
+            batching = false;
+        }
+        if (!ok) {
+            // Close the batch before recovery
+            dds.bus().endBatch();
+            batching = false;
+            auto e   = recover(dds, sim);
+            if (!e.empty()) {
+                return e;
+            }
+        }
+        if (!batching) {
+            sim.clearFaults();
+            auto e = check(dds, sim);
+            if (!e.empty()) {
+                return e + " at step " + std::to_string(step) + " op " + std::to_string(op % APPLY_OPS) + " (batched)";
+            }
+        }
+        ++step;
+    }
+    if (batching && !dds.bus().endBatch()) {
+        auto e = recover(dds, sim);
+        if (!e.empty()) {
+            return e;
+        }
+    }
+    auto e = check(dds, sim);
+    return e.empty() ? e : e + " at the end (batched)";
+}
+#endif
+
+// Runs all variants
+inline std::string run(const uint8_t* data, const size_t size)
+{
+    auto e = run_direct(data, size);
+#if defined(M5_UNIT_DDS_ENABLE_LINUX_BUS)
+    if (e.empty()) {
+        e = run_batched(data, size);
+    }
+#endif
+    return e;
+}
+
+}  // namespace dds_fuzz
+#endif
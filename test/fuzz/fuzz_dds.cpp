@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  Fuzz entry for BasicUnitDDS (See also dds_fuzz.hpp)
+
+  libFuzzer
+    clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined -Isrc -Itest/fuzz test/fuzz/fuzz_dds.cpp -o fuzz_dds
+    ./fuzz_dds -max_len=512
+  AFL++
+    afl-clang-fast++ -std=c++14 -O1 -DM5_UNIT_DDS_FUZZ_STANDALONE -Isrc -Itest/fuzz test/fuzz/fuzz_dds.cpp -o fuzz_dds
+    afl-fuzz -i seeds -o out -- ./fuzz_dds @@
+  Replay
+    g++ -std=c++14 -DM5_UNIT_DDS_FUZZ_STANDALONE -Isrc -Itest/fuzz test/fuzz/fuzz_dds.cpp -o fuzz_dds
+    ./fuzz_dds crash-...
+*/
+#include "dds_fuzz.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const auto e = dds_fuzz::run(data, size);
+    if (!e.empty()) {
+        std::fprintf(stderr, "Mismatch: %s\n", e.c_str());
+        std::abort();
+    }
+    return 0;
+}
+
+#if defined(M5_UNIT_DDS_FUZZ_STANDALONE)
+namespace {
+std::vector<uint8_t> read_all(FILE* fp)
+{
+    std::vector<uint8_t> v;
+    uint8_t buf[256];
+    size_t n{};
+    while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0) {
+        v.insert(v.end(), buf, buf + n);
+    }
+    return v;
+}
+}  // namespace
+
+// Runs each file of the arguments, or stdin if none
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        const auto v = read_all(stdin);
+        return LLVMFuzzerTestOneInput(v.data(), v.size());
+    }
+    for (int i = 1; i < argc; ++i) {
+        FILE* fp = std::fopen(argv[i], "rb");
+        if (!fp) {
+            std::fprintf(stderr, "Failed to open %s\n", argv[i]);
+            return 1;
+        }
+        const auto v = read_all(fp);
+        std::fclose(fp);
+        LLVMFuzzerTestOneInput(v.data(), v.size());
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  I2C_RDWR into the Simulator, test double of i2c-dev for BasicLinuxI2cBus
+  Shared by the fuzz harness and test/native/test_linux
+*/
+#ifndef M5_UNIT_DDS_TEST_SIMULATOR_IOCTL_HPP
+#define M5_UNIT_DDS_TEST_SIMULATOR_IOCTL_HPP
+
+#include <unit/dds_bus_linux.hpp>
+
+#if defined(M5_UNIT_DDS_ENABLE_LINUX_BUS)
+
+#include <unit/dds_simulator.hpp>
+#include <cstdint>
+
+namespace m5 {
+namespace unit {
+namespace dds {
+namespace bus {
+
+/*
+  A write message followed by a read message is a register read, others are register writes.
+  Messages are processed in order and stop at the first failure as the kernel does
+ */
+struct SimulatorIoctl {
+    Simulator* sim{};               // Target
+    uint8_t addr{DEFAULT_ADDRESS};  // Address of the simulated unit
+    uint32_t messages{};            // Number of processed messages
+
+    explicit SimulatorIoctl(Simulator* s = nullptr) : sim(s)
+    {
+    }
+
+    int ioctl(const int, const unsigned long request, void* arg)
+    {
+        if (request != I2C_RDWR || !sim) {
+            return -1;
+        }
+        auto data = static_cast<i2c_rdwr_ioctl_data*>(arg);
+        for (uint32_t i = 0; i < data->nmsgs; ++i) {
+            const auto& m = data->msgs[i];
+            ++messages;
+            if (m.addr != addr || (m.flags & I2C_M_RD) || !m.len) {
+                return -1;
+            }
+            if (i + 1 < data->nmsgs && (data->msgs[i + 1].flags & I2C_M_RD)) {
+                const auto& r = data->msgs[++i];
+                ++messages;
+                if (!sim->read(m.buf[0], r.buf, r.len)) {
+                    return -1;
+                }
+            } else if (!sim->write(m.buf[0], m.buf + 1, m.len - 1U)) {
+                return -1;
+            }
+        }
+        return static_cast<int>(data->nmsgs);
+    }
+};
+
+}  // namespace bus
+}  // namespace dds
+}  // namespace unit
+}  // namespace m5
+
+#endif
+#endif
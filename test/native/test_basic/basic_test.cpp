@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  UnitTest for BasicUnitDDS with the simulator
+*/
+#include <gtest/gtest.h>
+#include <unit/dds_basic.hpp>
+#include <unit/dds_simulator.hpp>
+
+using namespace m5::unit::dds;
+
+namespace {
+using SimDDS = BasicUnitDDS<bus::Simulator>;
+}  // namespace
+
+TEST(BasicUnitDDS, Begin)
+{
+    SimDDS dds;
+    EXPECT_TRUE(dds.begin());
+
+    char desc[7]{};
+    EXPECT_TRUE(dds.readDescription(desc));
+    EXPECT_STREQ(desc, "ad9833");
+
+    dds.bus().failNext(1);
+    EXPECT_FALSE(dds.begin());
+}
+
+TEST(BasicUnitDDS, Output)
+{
+    SimDDS dds;
+    ASSERT_TRUE(dds.begin());
+
+    EXPECT_TRUE(dds.writeOutput(Mode::Triangle, true, 1000, 90));
+    auto& sim = dds.bus();
+    EXPECT_EQ(sim.mode() & 0x07, static_cast<uint8_t>(Mode::Triangle));
+    EXPECT_EQ(sim.control() & 0x60, 0x60);
+    EXPECT_EQ(sim.ftw(true), frequency_to_ftw(1000));
+    EXPECT_EQ(sim.phase(true), degree_to_phase(90));
+    EXPECT_EQ(dds.frequency(true), 1000U);
+    EXPECT_EQ(dds.phase(true), 90U);
+    EXPECT_EQ(dds.control(), sim.control());
+
+    // Invalid values are rejected without bus access
+    sim.resetCounters();
+    EXPECT_FALSE(dds.writeFrequency(false, 1000001));
+    EXPECT_FALSE(dds.writeFrequencyWord(false, frequency_to_ftw(1000000) + 1));
+    EXPECT_FALSE(dds.writeFrequencyAndPhase(false, 1000001, false, 0));
+    EXPECT_FALSE(dds.sleep(false, false));
+    EXPECT_EQ(sim.writes() + sim.reads(), 0U);
+
+    // Phase wraps
+    EXPECT_TRUE(dds.writePhase(false, 360 + 45));
+    EXPECT_EQ(sim.phase(false), degree_to_phase(45));
+}
+
+TEST(BasicUnitDDS, Control)
+{
+    SimDDS dds;
+    ASSERT_TRUE(dds.begin());
+    auto& sim = dds.bus();
+
+    // A bank flip is a single CONTROL write from the shadow
+    sim.resetCounters();
+    EXPECT_TRUE(dds.writeCurrentFrequency(true));
+    EXPECT_TRUE(dds.writeCurrentPhase(true));
+    EXPECT_EQ(sim.writes(), 2U);
+    EXPECT_EQ(sim.reads(), 0U);
+    EXPECT_TRUE(dds.currentFrequencyBank());
+    EXPECT_TRUE(dds.currentPhaseBank());
+
+    EXPECT_TRUE(dds.sleep(true, false));
+    EXPECT_EQ(sim.control() & 0x18, 0x10);
+    EXPECT_TRUE(dds.reset());
+    EXPECT_EQ(sim.control() & 0x1C, 0x14);
+    EXPECT_TRUE(dds.wakeup());
+    EXPECT_EQ(sim.control() & 0x1C, 0x00);
+    EXPECT_EQ(sim.control() & 0x60, 0x60);
+
+    // The shadow is read again after a failed write
+    sim.failNext(1);
+    EXPECT_FALSE(dds.writeCurrent(false, false));
+    sim.resetCounters();
+    EXPECT_TRUE(dds.writeCurrent(false, false));
+    EXPECT_EQ(sim.reads(), 1U);
+    EXPECT_EQ(sim.control() & 0x60, 0x00);
+}
+
+TEST(BasicUnitDDS, Mode)
+{
+    SimDDS dds;
+    ASSERT_TRUE(dds.begin());
+    auto& sim = dds.bus();
+
+    EXPECT_TRUE(dds.writeOutput(Mode::Sin, false, 2000, 0));
+    EXPECT_TRUE(dds.writeFrequency(true, 3000));
+
+    // Sawtooth/DC clears the frequencies, they are written back on leaving
+    EXPECT_TRUE(dds.writeMode(Mode::Sawtooth));
+    EXPECT_EQ(sim.ftw(false), 0U);
+    EXPECT_EQ(sim.ftw(true), 0U);
+    EXPECT_TRUE(dds.writeMode(Mode::Square));
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(2000));
+    EXPECT_EQ(sim.ftw(true), frequency_to_ftw(3000));
+
+    Mode m{};
+    EXPECT_TRUE(dds.readMode(m));
+    EXPECT_EQ(m, Mode::Square);
+    EXPECT_EQ(dds.mode(), Mode::Square);
+
+    // Failed write keeps the shadow
+    sim.failNext(1);
+    EXPECT_FALSE(dds.writeFrequency(false, 5000));
+    EXPECT_EQ(dds.frequency(false), 2000U);
+}
@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  UnitTest for the frequency dithering with the time model
+*/
+#include <gtest/gtest.h>
+#include <unit/dds_dither.hpp>
+#include <random>
+#include <cmath>
+
+using namespace m5::unit::dds;
+
+namespace {
+
+// One FTW step (mHz)
+constexpr double STEP_MHZ{MCLK_HZ * 1000.0 / (1 << 28)};
+
+struct result_t {
+    double average_mhz{};  // Time-averaged frequency (mHz)
+    uint32_t switches{};
+};
+
+// Runs the sigma-delta for duration_us with jittered update intervals
+result_t simulate(const uint32_t millihertz, const uint32_t interval_us, const uint32_t jitter_us,
+                  const uint64_t duration_us, const uint32_t seed)
+{
+    uint32_t ftw{};
+    uint16_t frac{};
+    Dither::split(millihertz, ftw, frac);
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> jitter(0, jitter_us);
+    SigmaDelta sd(frac);
+    result_t r{};
+    uint64_t t{}, upper_us{};
+    while (t < duration_us) {
+        const uint32_t dt = interval_us + jitter(rng);
+        const bool upper  = sd.upper();
+        if (upper) {
+            upper_us += dt;
+        }
+        t += dt;
+        if (sd.next(dt) != upper) {
+            ++r.switches;
+        }
+    }
+    r.average_mhz = (ftw + static_cast<double>(upper_us) / t) * STEP_MHZ;
+    return r;
+}
+
+}  // namespace
+
+TEST(Dither, Split)
+{
+    uint32_t ftw{};
+    uint16_t frac{};
+    for (uint32_t hz : {0U, 1U, 1000U, 440000U, 999999U, 1000000U}) {
+        Dither::split(hz * 1000U, ftw, frac);
+        const uint32_t exact = frequency_to_ftw(hz);
+        // Lower FTW or the exact one
+        EXPECT_TRUE(ftw == exact || ftw + 1 == exact) << hz;
+        EXPECT_NEAR(Dither::to_millihertz(ftw, frac), hz * 1000U, 1) << hz;
+    }
+    // Fractions between the steps
+    Dither::split(1000012, ftw, frac);
+    EXPECT_EQ(ftw, 26843U);
+    EXPECT_NEAR(Dither::to_millihertz(ftw, frac), 1000012U, 1);
+    EXPECT_EQ(Dither::to_millihertz(ftw, 0), static_cast<uint32_t>(std::lround(ftw * STEP_MHZ)));
+}
+
+TEST(Dither, SigmaDelta)
+{
+    // Exact FTW never switches
+    SigmaDelta zero(0);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(zero.next(1000));
+    }
+    // Half alternates
+    SigmaDelta half(0x8000);
+    bool prev = half.upper();
+    for (int i = 0; i < 100; ++i) {
+        const bool v = half.next(1000);
+        EXPECT_NE(v, prev) << i;
+        prev = v;
+    }
+}
+
+TEST(Dither, AveragedFrequency)
+{
+    constexpr uint64_t duration_us{10 * 1000 * 1000};
+    constexpr uint32_t targets[] = {1000012, 1000000, 1000037, 440000001, 999999999, 20};
+    uint32_t seed{1};
+    for (auto&& target : targets) {
+        for (uint32_t jitter : {0U, 500U, 5000U}) {
+            auto r = simulate(target, 1000, jitter, duration_us, seed++);
+            // The error is bounded by a step over one interval, and the Q16 fraction
+            const double bound = STEP_MHZ * (1000 + jitter) / duration_us + STEP_MHZ / 65536;
+            EXPECT_LT(std::fabs(r.average_mhz - target), bound) << target << " jitter " << jitter;
+            // At most a switch per interval
+            EXPECT_LE(r.switches, duration_us / 1000) << target;
+        }
+    }
+}
+
+TEST(Dither, ShortTerm)
+{
+    // Half way between FTWs, the nearest FTW is off by a half step
+    const uint32_t target = Dither::to_millihertz(26843, 0x8000);
+    const double quantized =
+        std::fabs(Dither::to_millihertz(frequency_to_ftw((target + 500) / 1000), 0) - static_cast<double>(target));
+    EXPECT_GT(quantized, STEP_MHZ / 2 - 1);
+
+    // The error shrinks in proportion to the averaging time (the target is rounded to mHz)
+    for (uint64_t ms : {10U, 100U, 1000U}) {
+        auto r             = simulate(target, 1000, 200, ms * 1000U, 7);
+        const double err   = std::fabs(r.average_mhz - target);
+        const double bound = STEP_MHZ * 1200 / (ms * 1000U) + 0.5;
+        EXPECT_LT(err, bound) << ms;
+        EXPECT_LT(err, quantized) << ms;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  UnitTest replaying random inputs of the fuzz harness (See also test/fuzz)
+*/
+#include <gtest/gtest.h>
+#include "../../fuzz/dds_fuzz.hpp"
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SEED{20250101};
+
+std::vector<uint8_t> make_input(std::mt19937& rng, const size_t len)
+{
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> v(len);
+    for (auto& b : v) {
+        b = static_cast<uint8_t>(dist(rng));
+    }
+    return v;
+}
+
+}  // namespace
+
+TEST(Fuzz, Empty)
+{
+    EXPECT_TRUE(dds_fuzz::run(nullptr, 0).empty());
+}
+
+TEST(Fuzz, Random)
+{
+    std::mt19937 rng(SEED);
+    for (int i = 0; i < 4000; ++i) {
+        const auto v = make_input(rng, 16 + (i % 512));
+        const auto e = dds_fuzz::run(v.data(), v.size());
+        EXPECT_TRUE(e.empty()) << "#" << i << " " << e;
+        if (!e.empty()) {
+            break;
+        }
+    }
+}
+
+// Dense faults
+TEST(Fuzz, Faults)
+{
+    std::mt19937 rng(SEED + 1);
+    for (int i = 0; i < 1000; ++i) {
+        auto v = make_input(rng, 256);
+        // Calls consume a variable number of bytes, so the fault bytes are only hit by chance
+        for (size_t j = 1; j < v.size(); j += 4) {
+            v[j] = (v[j] & 0xF0) | (1 + (rng() & 1));  // failNext or loseAckNext
+        }
+        const auto e = dds_fuzz::run(v.data(), v.size());
+        EXPECT_TRUE(e.empty()) << "#" << i << " " << e;
+        if (!e.empty()) {
+            break;
+        }
+    }
+}
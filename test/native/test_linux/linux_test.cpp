@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  UnitTest for the Linux i2c-dev backend with the simulated ioctl
+*/
+#include <gtest/gtest.h>
+#include <unit/dds_basic.hpp>
+#include "../../fuzz/simulator_ioctl.hpp"
+
+#if defined(M5_UNIT_DDS_ENABLE_LINUX_BUS)
+
+using namespace m5::unit::dds;
+
+namespace {
+
+using FakeBus = bus::BasicLinuxI2cBus<bus::SimulatorIoctl>;
+
+class TestLinuxBus : public ::testing::Test {
+protected:
+    TestLinuxBus() : dds(3, bus::DEFAULT_ADDRESS, bus::SimulatorIoctl(&sim))
+    {
+    }
+    virtual void SetUp() override
+    {
+        ASSERT_TRUE(dds.begin());
+        dds.bus().resetSyscalls();
+    }
+    uint32_t syscalls()
+    {
+        auto n = dds.bus().syscalls();
+        dds.bus().resetSyscalls();
+        return n;
+    }
+
+    bus::Simulator sim{};
+    BasicUnitDDS<FakeBus> dds;
+};
+
+}  // namespace
+
+TEST_F(TestLinuxBus, SyscallsPerOperation)
+{
+    Mode m{};
+    uint8_t ctrl{};
+    char desc[7]{};
+
+    // Each register access is one ioctl
+    EXPECT_TRUE(dds.readMode(m));
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_TRUE(dds.readControl(ctrl));
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_TRUE(dds.readDescription(desc));
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_STREQ(desc, "ad9833");
+
+    EXPECT_TRUE(dds.writeFrequency(false, 1000));
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_TRUE(dds.writeFrequencyAndPhase(true, 2000, true, 90));
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_TRUE(dds.writeCurrent(true, true));
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_TRUE(dds.writeMode(Mode::Triangle));  // MODE from the cache
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_TRUE(dds.writeOutput(Mode::Sin, false, 3000, 0));
+    EXPECT_EQ(syscalls(), 3U);
+
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(3000));
+    EXPECT_EQ(sim.ftw(true), frequency_to_ftw(2000));
+    EXPECT_EQ(sim.phase(true), degree_to_phase(90));
+    EXPECT_EQ(sim.mode() & 0x07, static_cast<uint8_t>(Mode::Sin));
+    EXPECT_EQ(sim.control() & 0x60, 0x00);
+}
+
+TEST_F(TestLinuxBus, Batch)
+{
+    // Both banks and the flip in a single ioctl
+    const auto messages = dds.bus().syscall().messages;
+    dds.bus().beginBatch();
+    EXPECT_TRUE(dds.writeFrequencyAndPhase(false, 1000, false, 0));
+    EXPECT_TRUE(dds.writeFrequencyAndPhase(true, 2000, true, 180));
+    EXPECT_TRUE(dds.writeCurrent(true, true));
+    EXPECT_EQ(dds.bus().queued(), 3U);
+    EXPECT_EQ(sim.ftw(true), 0U);  // Not sent yet
+    EXPECT_TRUE(dds.bus().endBatch());
+    EXPECT_EQ(syscalls(), 1U);
+    EXPECT_EQ(dds.bus().syscall().messages - messages, 3U);
+
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(1000));
+    EXPECT_EQ(sim.ftw(true), frequency_to_ftw(2000));
+    EXPECT_EQ(sim.phase(true), degree_to_phase(180));
+    EXPECT_EQ(sim.control() & 0x60, 0x60);
+
+    // A read flushes the queue first to keep the order
+    dds.bus().beginBatch();
+    EXPECT_TRUE(dds.writeCurrent(false, false));
+    uint8_t ctrl{};
+    EXPECT_TRUE(dds.readControl(ctrl));
+    EXPECT_EQ(ctrl & 0x60, 0x00);
+    EXPECT_TRUE(dds.bus().endBatch());
+    EXPECT_EQ(syscalls(), 2U);
+
+    // Full queue is sent automatically
+    dds.bus().beginBatch();
+    for (uint32_t i = 0; i < FakeBus::MAX_BATCH + 1; ++i) {
+        EXPECT_TRUE(dds.writeFrequency(false, 100 * i));
+    }
+    EXPECT_EQ(dds.bus().queued(), 1U);
+    EXPECT_TRUE(dds.bus().endBatch());
+    EXPECT_EQ(syscalls(), 2U);
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(100 * FakeBus::MAX_BATCH));
+}
+
+TEST_F(TestLinuxBus, Failure)
+{
+    sim.failNext(1);
+    EXPECT_FALSE(dds.writeFrequency(false, 1000));
+    EXPECT_EQ(dds.frequency(false), 0U);
+
+    // The batch result is reported at the end
+    dds.bus().beginBatch();
+    EXPECT_TRUE(dds.writeFrequency(false, 1000));
+    sim.failNext(1);
+    EXPECT_FALSE(dds.bus().endBatch());
+    EXPECT_EQ(dds.bus().queued(), 0U);
+}
+
+#endif
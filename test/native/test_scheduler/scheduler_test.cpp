@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  UnitTest for BasicScheduler with a virtual clock
+*/
+#include <gtest/gtest.h>
+#include <unit/dds_basic.hpp>
+#include <unit/dds_simulator.hpp>
+#include <unit/dds_scheduler.hpp>
+
+using namespace m5::unit::dds;
+
+namespace {
+// Each transaction advances the virtual clock
+class TimedBus : public bus::Simulator {
+public:
+    bool write(const uint8_t reg, const uint8_t* buf, const size_t len)
+    {
+        now += cost_us;
+        return bus::Simulator::write(reg, buf, len);
+    }
+    bool read(const uint8_t reg, uint8_t* buf, const size_t len)
+    {
+        now += cost_us;
+        return bus::Simulator::read(reg, buf, len);
+    }
+    uint64_t now{};
+    uint32_t cost_us{100};
+};
+
+using TimedDDS = BasicUnitDDS<TimedBus>;
+
+struct SchedulerTest : public ::testing::Test {
+    SchedulerTest() : sched(dds, 4, [this]() { return dds.bus().now; })
+    {
+    }
+    void SetUp() override
+    {
+        ASSERT_TRUE(dds.begin());
+        ASSERT_TRUE(dds.writeCurrent(false, false));
+        dds.bus().now = 0;
+    }
+    TimedDDS dds;
+    BasicScheduler<TimedDDS> sched;
+};
+}  // namespace
+
+TEST_F(SchedulerTest, PrepareAndFlip)
+{
+    auto& sim = dds.bus();
+    auto cfg  = sched.config();
+    cfg.lead_us = 1000;
+    sched.config(cfg);
+
+    EXPECT_TRUE(sched.schedule(5000, 1234, 90));
+    EXPECT_EQ(sched.nextDeadline(), 5000U);
+
+    // Too early to prepare
+    sim.now = 3000;
+    EXPECT_EQ(sched.update(), 0U);
+    EXPECT_EQ(sim.writes(), 1U);  // writeCurrent in SetUp
+
+    // Prepared in the inactive bank, not flipped yet
+    sim.now = 4000;
+    sim.resetCounters();
+    EXPECT_EQ(sched.update(), 0U);
+    EXPECT_EQ(sim.writes(), 1U);
+    EXPECT_EQ(sim.ftw(true), frequency_to_ftw(1234));
+    EXPECT_EQ(sim.phase(true), degree_to_phase(90));
+    EXPECT_EQ(sim.control() & 0x60, 0x00);
+
+    // Flip with a single CONTROL write, lateness includes the write
+    sim.now = 5000;
+    sim.resetCounters();
+    EXPECT_EQ(sched.update(), 1U);
+    EXPECT_EQ(sim.writes(), 1U);
+    EXPECT_EQ(sim.control() & 0x60, 0x60);
+    EXPECT_EQ(sched.pending(), 0U);
+
+    auto& st = sched.statistics();
+    EXPECT_EQ(st.executed, 1U);
+    EXPECT_EQ(st.max_lateness, 100U);
+    EXPECT_EQ(st.average(), 100U);
+    EXPECT_EQ(st.late, 0U);
+}
+
+TEST_F(SchedulerTest, Lateness)
+{
+    auto& sim = dds.bus();
+    auto cfg  = sched.config();
+    cfg.late_us = 150;
+    sched.config(cfg);
+
+    EXPECT_TRUE(sched.schedule(1000, 1000));
+    EXPECT_TRUE(sched.schedule(2000, 2000));
+
+    // Prepare and flip in one update: 100 us for prepare, 100 us for flip
+    sim.now = 1000;
+    EXPECT_EQ(sched.update(), 1U);
+    EXPECT_EQ(sched.statistics().max_lateness, 200U);
+    EXPECT_EQ(sched.statistics().late, 1U);
+
+    // The next command was prepared right after the flip, only the flip is late
+    sim.now = 2000;
+    EXPECT_EQ(sched.update(), 1U);
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(2000));
+    EXPECT_EQ(sim.control() & 0x60, 0x00);
+
+    EXPECT_EQ(sched.statistics().executed, 2U);
+    EXPECT_EQ(sched.statistics().total_lateness, 300U);
+    EXPECT_EQ(sched.statistics().average(), 150U);
+}
+
+TEST_F(SchedulerTest, Order)
+{
+    auto& sim = dds.bus();
+    EXPECT_TRUE(sched.schedule(3000, 3000));
+    EXPECT_TRUE(sched.schedule(1000, 1000));
+    EXPECT_TRUE(sched.schedule(2000, 2000));
+    EXPECT_TRUE(sched.schedule(4000, 4000));
+    EXPECT_FALSE(sched.schedule(5000, 5000));  // Full
+    EXPECT_EQ(sched.nextDeadline(), 1000U);
+
+    sim.now = 10000;
+    EXPECT_EQ(sched.update(), 4U);
+    EXPECT_EQ(dds.frequency(dds.currentFrequencyBank()), 4000U);
+
+    sched.clear();
+    EXPECT_EQ(sched.pending(), 0U);
+    EXPECT_EQ(sched.nextDeadline(), 0U);
+}
+
+TEST_F(SchedulerTest, Failure)
+{
+    auto& sim = dds.bus();
+
+    // Failed flip leaves CONTROL unknown
+    EXPECT_TRUE(sched.schedule(1000, 1000));
+    EXPECT_EQ(sched.update(), 0U);  // Prepared
+    sim.now = 1000;
+    sim.loseAckNext(1);  // The flip is applied but not acknowledged
+    EXPECT_EQ(sched.update(), 0U);
+    EXPECT_EQ(sched.statistics().failed, 1U);
+    EXPECT_FALSE(dds.controlValid());
+
+    // CONTROL is read again before choosing the inactive bank
+    EXPECT_TRUE(sched.schedule(2000, 2000));
+    sim.now = 2000;
+    sim.resetCounters();
+    EXPECT_EQ(sched.update(), 1U);
+    EXPECT_EQ(sim.reads(), 1U);
+    EXPECT_TRUE(dds.controlValid());
+    EXPECT_EQ(sim.ftw(false), frequency_to_ftw(2000));
+    EXPECT_EQ(sim.control() & 0x60, 0x00);
+}